@@ -0,0 +1,40 @@
+#ifndef _ASYNC_H_
+#define _ASYNC_H_
+
+#include <stddef.h>
+
+#include "edwards_curve.h"
+#include "key_pool.h"
+
+// Completion-queue interface to the class group action. Requests are submitted without blocking,
+// computed by an internal pool of threads, and collected by csidh_poll() once the descriptor returned
+// by csidh_async_fd() becomes readable (it is an eventfd, thus it can be added to a poll/epoll set).
+typedef struct csidh_async csidh_async;
+
+enum {
+	CSIDH_ASYNC_ACTION = 1,	// out = sk * in (in is trusted, no validation)
+	CSIDH_ASYNC_DERIVE = 2,	// out = sk * in if in is a valid public curve
+	CSIDH_ASYNC_KEYGEN = 3	// fresh sk, and out = sk * E
+};
+
+// A request is owned by the caller: it must stay untouched from csidh_submit() until csidh_poll()
+// hands it back. Only op, sk, in and user_data are read; sk, out and valid are written.
+typedef struct csidh_request {
+	uint8_t op;
+	uint8_t valid;		// 0 if a CSIDH_ASYNC_DERIVE input was rejected (sk and out are wiped)
+	uint8_t sk[N];
+	proj in;
+	proj out;
+	void *user_data;
+	struct csidh_request *next;	// internal
+} csidh_request;
+
+csidh_async *csidh_async_create(uint32_t threads, key_pool *pool);
+void csidh_async_destroy(csidh_async *ctx);
+int csidh_async_fd(const csidh_async *ctx);
+
+void csidh_submit(csidh_async *ctx, csidh_request *request);
+size_t csidh_poll(csidh_async *ctx, csidh_request *completions[], size_t max);
+void csidh_async_counts(csidh_async *ctx, size_t *queued, size_t *running);
+
+#endif /* Asynchronous CSIDH */
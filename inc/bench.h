@@ -0,0 +1,98 @@
+#ifndef _BENCH_H_
+#define _BENCH_H_
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stddef.h>
+
+// Cycle measurements: bench_start() and bench_stop() read the time-stamp counter with the fences
+// required for the measured code to neither start before nor finish after the reads.
+static inline uint64_t bench_start(void)
+{
+	uint32_t lo, hi;
+	asm volatile("lfence\n\trdtsc\n\tlfence" : "=a"(lo), "=d"(hi) :: "memory");
+	return ((uint64_t)hi << 32) | lo;
+};
+
+static inline uint64_t bench_stop(void)
+{
+	uint32_t lo, hi;
+	asm volatile("rdtscp\n\tlfence" : "=a"(lo), "=d"(hi) :: "rcx", "memory");
+	return ((uint64_t)hi << 32) | lo;
+};
+
+typedef enum {
+	BENCH_TEXT = 0,
+	BENCH_JSON = 1,
+	BENCH_CSV  = 2
+} bench_format;
+
+typedef struct {
+	const char *name;
+	uint64_t *values;
+	size_t count, capacity;
+} bench_samples;
+
+typedef struct {
+	size_t count;
+	double mean, stddev;
+	uint64_t min, max, median, p90, p99;
+} bench_summary;
+
+// Hardware performance counters of the calling thread (user space only), read with perf_event_open().
+// Each counter is optional: the ones the kernel or the CPU refuse are reported as unavailable. They are
+// opened as one group (always scheduled together), and scaled by the time they were running whenever
+// the kernel had to multiplex them with other events.
+enum {
+	BENCH_CYCLES = 0,
+	BENCH_INSTRUCTIONS,
+	BENCH_BRANCH_MISSES,
+	BENCH_L1D_MISSES,	// L1 data cache read misses
+	BENCH_COUNTERS
+};
+
+typedef struct {
+	int fd[BENCH_COUNTERS];		// -1 if unavailable
+	uint64_t start[BENCH_COUNTERS], enabled[BENCH_COUNTERS], running[BENCH_COUNTERS];
+} bench_counters;
+
+// Totals of the counters over several measurements (e.g., of one phase)
+typedef struct {
+	uint64_t total[BENCH_COUNTERS];
+	uint64_t measurements;
+	uint64_t multiplexed;		// measurements whose counts were scaled
+} bench_counts;
+
+extern const char *BENCH_COUNTER_NAMES[BENCH_COUNTERS];
+
+// Environment of a run, reported along the results
+typedef struct {
+	const char *program;
+	int cpu;			// pinned CPU, or -1
+	uint8_t invariant_tsc;		// the counter runs at a constant rate (CPUID 0x80000007)
+	char governor[32];		// cpufreq governor of the CPU, or "unknown"
+	size_t iterations, warmup;
+	const char *unit;		// of the measurements ("cycles" by default)
+} bench_environment;
+
+int bench_samples_init(bench_samples *s, const char *name, size_t capacity);
+void bench_samples_add(bench_samples *s, uint64_t value);
+void bench_samples_free(bench_samples *s);
+void bench_summarize(const bench_samples *s, bench_summary *summary);
+
+int bench_pin(int cpu);
+void bench_environment_init(bench_environment *env, const char *program, int cpu, size_t iterations, size_t warmup);
+int bench_parse_format(const char *str, bench_format *format);
+
+int bench_counters_open(bench_counters *c);
+void bench_counters_start(bench_counters *c);
+void bench_counters_stop(const bench_counters *c, bench_counts *counts);
+void bench_counters_close(bench_counters *c);
+void bench_report_counters(FILE *out, bench_format format, const char *name, const bench_counters *c,
+                           const bench_counts *counts, int first);
+
+void bench_report_begin(FILE *out, bench_format format, const bench_environment *env);
+void bench_report(FILE *out, bench_format format, const char *name, const bench_summary *summary, int first);
+void bench_report_end(FILE *out, bench_format format);
+
+#endif /* Benchmarks */
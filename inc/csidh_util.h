@@ -3,6 +3,7 @@
 
 #include "fp.h"
 #include "edwards_curve.h"
+#include "public_key.h"
 
 extern const fp R_mod_p;
 
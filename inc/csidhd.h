@@ -0,0 +1,67 @@
+#ifndef CSIDHD_H
+#define CSIDHD_H
+
+#include <stdint.h>
+
+/*
+ * Binary protocol of the csidhd key-derivation daemon (UNIX stream socket).
+ *
+ * Each request is a csidhd_request header followed by the payload of its operation:
+ *   CSIDHD_DERIVE: private key (N bytes) || public key (normalized Montgomery form, little endian)
+ *   CSIDHD_KEYGEN: no payload
+ *   CSIDHD_STATS:  no payload
+ * Each response is a csidhd_response header followed by `length` bytes:
+ *   CSIDHD_DERIVE: shared secret (normalized Montgomery form, little endian)
+ *   CSIDHD_KEYGEN: private key (N bytes) || public key (normalized Montgomery form, little endian)
+ *   CSIDHD_STATS:  csidhd_stats
+ * Requests are queued and computed by a pool of workers, so the responses of a connection can arrive
+ * in any order: they are matched with the requests by the id chosen by the client.
+ * All the integers are in the host byte order (the socket is local).
+ */
+
+#define CSIDHD_MAGIC 0x48444943	// "CIDH"
+#define CSIDHD_SOCKET "/tmp/csidhd.sock"
+
+enum {
+	CSIDHD_DERIVE = 1,
+	CSIDHD_KEYGEN = 2,
+	CSIDHD_STATS  = 3
+};
+
+enum {
+	CSIDHD_OK          = 0,
+	CSIDHD_INVALID     = 1,	// the public key was rejected by validate()
+	CSIDHD_BAD_REQUEST = 2,	// unknown operation or magic number (the connection is closed)
+	CSIDHD_BUSY        = 3	// the request queue is full
+};
+
+typedef struct {
+	uint32_t magic;
+	uint8_t op;
+	uint8_t reserved[3];
+	uint64_t id;
+} __attribute__((packed)) csidhd_request;
+
+typedef struct {
+	uint32_t magic;
+	uint8_t op;
+	uint8_t status;
+	uint16_t length;
+	uint64_t id;
+} __attribute__((packed)) csidhd_response;
+
+#define CSIDHD_HISTOGRAM 32	// bucket i counts the requests served in [2^i, 2^(i+1)) microseconds
+
+typedef struct {
+	uint64_t queue_depth;		// requests waiting for a worker
+	uint64_t in_flight;		// requests being computed
+	uint64_t completed;
+	uint64_t invalid;
+	uint64_t busy;
+	uint64_t pool_available;	// ephemeral key pairs ready for CSIDHD_KEYGEN
+	uint64_t pool_depleted;
+	uint64_t derive_latency[CSIDHD_HISTOGRAM];
+	uint64_t keygen_latency[CSIDHD_HISTOGRAM];
+} csidhd_stats;
+
+#endif
@@ -6,14 +6,20 @@
 #include<stdint.h>
 
 #include "fp.h"
+#include "trace.h"
 
 // projective Edwards y-coordinates (to be used with the patching)
 typedef uint64_t proj[2][NUMBER_OF_WORDS]	__attribute__((aligned(64)));
 // A curve will be defined as type proj where the first and second entries will be the constants a and (a -d).
 
-uint64_t FP_ADD_COMPUTED,	// Variable used for counting the number of field additions.
-	 FP_SQR_COMPUTED,	// Variable used for counting the number of field squarings.
-         FP_MUL_COMPUTED;	// Variable used for counting the number of field multiplications.
+// The counters are thread-local, so concurrent actions (see parallel.h) do not race on them.
+extern __thread uint64_t FP_ADD_COMPUTED,	// Variable used for counting the number of field additions.
+	 FP_SQR_COMPUTED,			// Variable used for counting the number of field squarings.
+         FP_MUL_COMPUTED;			// Variable used for counting the number of field multiplications.
+
+// Cooperative cancellation of action_evaluation(): when the calling thread sets ACTION_ABORT, the action
+// stops at the beginning of the next round once *ACTION_ABORT != 0 (its output must then be discarded).
+extern __thread volatile uint8_t *ACTION_ABORT;
 
 // Framework to be used: the files required must be in the folder: ./inc/fp$(BITLENGTH_OF_P)/
 #include "addc.h"			// Addition chains, Public curve, public points T_{+} and T_{-}, and the list of prime factors l_i's
@@ -24,6 +30,8 @@ uint64_t FP_ADD_COMPUTED,	// Variable used for counting the number of field addi
 	#include "simba_withdummy_2.h"	// csidh with dummy operations and using two torsion point T_{+} and T_{-}
 #elif defined DUMMYFREE
 	#include "simba_dummyfree.h"	// dummy-free csidh using two torsion points T_{+} and T_{-}
+#elif defined VARTIME
+	#include "simba_dummyfree.h"	// variable-time csidh for public exponents, with the keys of DUMMYFREE
 #endif
 
 // Functions related with the point arithmetic
@@ -33,16 +41,38 @@ uint8_t areEqual(const proj P, const proj Q);	// To check if two points are equa
 
 void yDBL(proj Q, const proj P, const proj A);
 void yADD(proj R, const proj P, const proj Q, const proj PQ);
+void yQUAD(proj Q, const proj P, const proj A);
+void yTPL(proj Q, const proj P, const proj A);
 void yMUL(proj Q, const proj P, const proj A, uint8_t const i);
 
 void elligator(proj T_plus, proj T_minus, const proj A);
 
-void cofactor_multiples(proj P[], const proj A, int8_t lower, int8_t upper);
+void cofactor_multiples(proj P[], const proj A, int16_t lower, int16_t upper);
 uint8_t validate(const proj A);
 
+// Kernel points of an isogeny kept at once. By default the whole kernel [P], [2]P, ..., [(l - 1)/2]P
+// (and a spare entry) is written by yISOG(); with KERNEL_BUDGET (bytes, make ... KERNEL_BUDGET=4096)
+// the action streams the kernel through a ring buffer of KERNEL_BLOCK points with yISOG_EVAL().
+#if defined KERNEL_BUDGET
+	#define KERNEL_BLOCK (((KERNEL_BUDGET) / (int)sizeof(proj)) < 4 ? 4 : ((KERNEL_BUDGET) / (int)sizeof(proj)))
+	#define KERNEL_INDEX(j) ((j) % KERNEL_BLOCK)
+#else
+	#define KERNEL_BLOCK ((LARGE_L >> 1) + 1)
+	#define KERNEL_INDEX(j) (j)
+#endif
+#define ISOG_EVAL_POINTS 2	// Points evaluated at most by yISOG_EVAL()
+
 // Functions related with isogenies
 void yISOG(proj Pk[], proj C, const proj P, const proj A, const uint8_t i);
 void yEVAL(proj R, const proj Q, const proj Pk[], const uint8_t i);
+void yISOG_EVAL(proj Pk[], proj C, proj R[], const proj Q[], const uint8_t count, const proj P, const proj A,
+                const uint8_t i);
+
+// Chains of degree-3 and degree-5 isogenies by radical isogenies (see lib/radical.c): with RADICAL (make
+// ... RADICAL=1) the action walks these l_i's with radical_isogenies() and SIMBA starts with them finished.
+#define RADICAL_DEGREE(l) (((l) == 3) || ((l) == 5))
+void radical_isogenies(proj C, const proj A, const uint8_t i, const uint8_t e, const uint8_t positive,
+                       const uint8_t bound);
 
 // functions related with the action
 void action_evaluation(proj C, const uint8_t key[], const proj A);
@@ -26,14 +26,33 @@
 //         fp_random(input);
 // This above functions must be implemented allowing that the output variable can be one of the inputs.
 
+// The next parameter sets, and their lib/fpNNNN.S and inc/fpNNNN/, are generated by tools/csidh_params.py
+#elif defined FP_1024
+	#define N 130			// Number of l_i's such that l_i | [(p+1)/4]
+	#define LOG2_OF_N_PLUS_ONE 8
+	#define NUMBER_OF_WORDS 16	// Number of 64-bit words
+
+#elif defined FP_1792
+	#define N 207			// Number of l_i's such that l_i | [(p+1)/4]
+	#define LOG2_OF_N_PLUS_ONE 8
+	#define NUMBER_OF_WORDS 28	// Number of 64-bit words
+
+#elif defined FP_2048
+	#define N 231			// Number of l_i's such that l_i | [(p+1)/4]
+	#define LOG2_OF_N_PLUS_ONE 8
+	#define NUMBER_OF_WORDS 32	// Number of 64-bit words
+
 #endif
 
-typedef uint64_t fp[NUMBER_OF_WORDS]      __attribute__((aligned(64)));		// 512-bits integer number in Montgomery domain (To be used with the patching)
+// Cache-line aligned when arrays of fp allow it (the size of an element must be a multiple of its alignment)
+#define FP_ALIGNMENT (((NUMBER_OF_WORDS % 8) == 0) ? 64 : 32)
+typedef uint64_t fp[NUMBER_OF_WORDS]      __attribute__((aligned(FP_ALIGNMENT)));		// (64 * NUMBER_OF_WORDS)-bits integer number in Montgomery domain (To be used with the patching)
 
 extern const fp p;
 extern const fp R_mod_p;
-extern const fp R_squared_mod_p;	// required for mapping a random fp element 2 <= u <= (p-1)/2 into the Montgomery domain
-extern const fp p_minus_1_halves;	// (p-1)/2 used for find a random fp element 2 <= u <= (p-1)/2
+extern const fp R_squared_mod_p;	// required for mapping a random fp element into the Montgomery domain
+extern const fp R_cubed_mod_p;		// required for mapping the upper word of a wide random integer into the Montgomery domain
+extern const fp p_minus_1_halves;	// (p-1)/2
 
 // All operations are perfomed in the Montgomery domain
 void fp_cswap(fp x, fp y, uint8_t c);
@@ -45,7 +64,8 @@ void fp_sqr(fp b, const fp a);
 
 void fp_inv(fp x);
 uint8_t fp_issquare(fp const x);
-void fp_random(fp x);	// This function should be modified in order to have a better random function: e.g., shake256.
+void fp_random(fp x);	// random integer 0 <= x < p (rejection sampling, not in Montgomery domain)
+void fp_random_montgomery(fp x);	// random element of F_p in Montgomery domain (constant-time, no rejection; see point_arith.c)
 
 #define set_zero(x, NUM)\
 	memset(x, 0, sizeof(uint64_t) * NUM);
@@ -138,9 +158,33 @@ static uint32_t isequal(uint32_t a, uint32_t b)
 	return (uint32_t)(1-r);
 }
 
+// The exponents of an action are kept in KEY_STATE bytes (N rounded up to a multiple of 32) aligned to
+// 32 bytes, so that lookup() and update() go through all of them with 32-byte AVX2 vectors.
+#define KEY_STATE (((N) + 31) & ~31)
+
 /* get priv[pos] in constant time  */
 static uint32_t lookup(size_t pos, int8_t const priv[])
 {
+#if defined __AVX2__
+	// Each byte is selected by comparing its index with pos (the indices wrap around at 256 > N)
+	const __m256i position = _mm256_set1_epi8((char)pos), step = _mm256_set1_epi8(32);
+	__m256i index = _mm256_setr_epi8( 0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15,
+	                                 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31);
+	__m256i r = _mm256_setzero_si256();
+	for(size_t i = 0; i < KEY_STATE; i += 32)
+	{
+		__m256i mask = _mm256_cmpeq_epi8(index, position);
+		r = _mm256_or_si256(r, _mm256_and_si256(mask, _mm256_load_si256((const __m256i *)&priv[i])));
+		index = _mm256_add_epi8(index, step);
+	}
+	// Only one byte of r is not zero
+	__m128i t = _mm_or_si128(_mm256_castsi256_si128(r), _mm256_extracti128_si256(r, 1));
+	t = _mm_or_si128(t, _mm_srli_si128(t, 8));
+	t = _mm_or_si128(t, _mm_srli_si128(t, 4));
+	t = _mm_or_si128(t, _mm_srli_si128(t, 2));
+	t = _mm_or_si128(t, _mm_srli_si128(t, 1));
+	return (int8_t)_mm_cvtsi128_si32(t);
+#else
 	int b;
 	int8_t r = priv[0];
 	for(size_t i = 1; i < N; i++)
@@ -149,6 +193,27 @@ static uint32_t lookup(size_t pos, int8_t const priv[])
 		cmov(&r, priv[i], b);
 	}
 	return r;
+#endif
+}
+
+/* set priv[pos] to a in constant time: every byte of priv is written */
+static void update(size_t pos, int8_t priv[], const int8_t a)
+{
+#if defined __AVX2__
+	const __m256i position = _mm256_set1_epi8((char)pos), step = _mm256_set1_epi8(32), value = _mm256_set1_epi8(a);
+	__m256i index = _mm256_setr_epi8( 0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15,
+	                                 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31);
+	for(size_t i = 0; i < KEY_STATE; i += 32)
+	{
+		__m256i mask = _mm256_cmpeq_epi8(index, position);
+		__m256i data = _mm256_load_si256((const __m256i *)&priv[i]);
+		_mm256_store_si256((__m256i *)&priv[i], _mm256_blendv_epi8(data, value, mask));
+		index = _mm256_add_epi8(index, step);
+	}
+#else
+	for(size_t i = 0; i < N; i++)
+		cmov(&priv[i], a, isequal(i, pos));
+#endif
 }
 
 // constant-time comparison: -1 if x < y, 0 otherwise.
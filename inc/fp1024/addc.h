@@ -0,0 +1,99 @@
+#ifndef _ADDC_H_
+#define _ADDC_H_
+
+// Generated by tools/csidh_params.py
+
+// The public Edward's curve with coefficients a and b. E is isomorphic to E' / F_p : y^2 = x^3 + x
+// a and (a - d) in Montgomery domain represetantion 
+static proj E = {
+{ 0xCBCFDCCB21CCACFA, 0x814BE4B0FFDF0DA8, 0x33F3CC0F733AC5E4, 0x2113BEA1E9F1E4DB, 0xB25121BA0576B0B4, 0xC36D7CD172D3D972, 0x5D7C782072BE6787, 0xBDF2CA472CA63E37, 0x51A6FB6ED6F436FE, 0xDA113F48E96947E, 0xB79C24198F49FFE5, 0x1167F28E26E68159, 0x227E7CF8E366F9CA, 0x8FA362F613D88AEF, 0x3B0695FEDEF2AD6D, 0x898967D2D1D8571},	// a
+{ 0xBBBC6D41E2B5F5A1, 0x60BFAA764380E703, 0x169BF0F22D9CEBF5, 0x7F5CC6A2F15BD7F9, 0x777926B0BC2A5E, 0x1BA97D4EB45393A5, 0x17C996F06FAE12A, 0x726CB89F80425116, 0x2D3C498E1DA4517D, 0x23304E250340A5D3, 0x21CBEEE893BBD29C, 0x326202D530D3CA45, 0x3E792ACBEB9C4638, 0xFDDAA32FA0BEFBD6, 0x9D6F3F762DDD6F03, 0x262D70D17CAF838}	// a - d
+};
+
+// Shortest differential addition chains for each l_i
+static uint64_t ADDITION_CHAIN[] = {
+0x10C0, 0x600, 0x148, 0x290, 0x80A, 0x828, 0x680, 0x580,
+0x1A0, 0xD0, 0x620, 0x904, 0x920, 0xA50, 0x5A0, 0x88A,
+0xD00, 0x320, 0x588, 0xB40, 0x4B0, 0x2C4, 0x912, 0xC20,
+0xB10, 0x328, 0xA18, 0x960, 0x700, 0x6A4, 0x80, 0xCA0,
+0x1D0, 0x400, 0xB60, 0x140, 0x220, 0x720, 0x500, 0xE80,
+0x408, 0x150, 0xD90, 0x214, 0x144, 0xC0, 0xEA0, 0x248,
+0x520, 0x5D8, 0x444, 0x50A, 0x528, 0x320, 0xC8, 0x130,
+0x5A0, 0x268, 0x4C0, 0x640, 0x590, 0x5A8, 0x4D0, 0x20,
+0x6A8, 0x140, 0x50, 0xA0, 0x108, 0x202, 0x240, 0x148,
+0x2A0, 0x288, 0x228, 0x250, 0x242, 0x118, 0x340, 0x162,
+0x0, 0x310, 0x260, 0x2C4, 0x314, 0x100, 0xE8, 0x82,
+0x88, 0xA8, 0x110, 0xC0, 0x60, 0xD0, 0x180, 0x98,
+0x1A0, 0x184, 0x190, 0x40, 0x70, 0x1D0, 0x84, 0x60,
+0x30, 0x68, 0xC0, 0x0, 0x6C, 0x10, 0x14, 0x50,
+0x48, 0x2C, 0x58, 0x4C, 0x20, 0x22, 0x18, 0x30,
+0x8, 0x10, 0x18, 0x4, 0xA, 0x0, 0x4, 0x2,
+0x0, 0x0
+};
+
+// Length of the shortest differential addition chain for each l_i
+static uint8_t ADDITION_CHAIN_LENGTH[] = {
+13, 12, 12, 12, 12, 12, 12, 12,
+12, 12, 12, 12, 12, 12, 12, 12,
+12, 12, 12, 12, 12, 12, 12, 12,
+12, 12, 12, 12, 12, 12, 11, 12,
+12, 11, 12, 11, 11, 12, 11, 12,
+11, 11, 12, 11, 11, 11, 12, 11,
+11, 12, 11, 11, 11, 11, 11, 11,
+11, 11, 11, 11, 11, 11, 11, 10,
+11, 10, 10, 10, 10, 10, 10, 10,
+10, 10, 10, 10, 10, 10, 10, 10,
+ 9, 10, 10, 10, 10,  9, 10,  9,
+ 9,  9,  9,  9,  9,  9,  9,  9,
+ 9,  9,  9,  8,  9,  9,  8,  8,
+ 8,  8,  8,  7,  8,  7,  7,  7,
+ 7,  7,  7,  7,  6,  6,  6,  6,
+ 5,  5,  5,  4,  4,  3,  3,  2,
+ 1,  0
+};
+
+// L
+static uint32_t L[] = { 
+983, 733, 727, 719, 709, 701, 691, 683,
+677, 673, 661, 659, 653, 647, 643, 641,
+631, 619, 617, 613, 607, 601, 599, 593,
+587, 577, 571, 569, 563, 557, 547, 541,
+523, 521, 509, 503, 499, 491, 487, 479,
+467, 463, 461, 457, 449, 443, 439, 433,
+431, 421, 419, 409, 401, 397, 389, 383,
+379, 373, 367, 359, 353, 349, 347, 337,
+331, 317, 313, 311, 307, 293, 283, 281,
+277, 271, 269, 263, 257, 251, 241, 239,
+233, 229, 227, 223, 211, 199, 197, 193,
+191, 181, 179, 173, 167, 163, 157, 151,
+149, 139, 137, 131, 127, 113, 109, 107,
+103, 101,  97,  89,  83,  79,  73,  71,
+ 67,  61,  59,  53,  47,  43,  41,  37,
+ 31,  29,  23,  19,  17,  13,  11,   7,
+  5,   3
+};
+
+static uint16_t BITS_OF_L[] = { 
+10, 10, 10, 10, 10, 10, 10, 10,
+10, 10, 10, 10, 10, 10, 10, 10,
+10, 10, 10, 10, 10, 10, 10, 10,
+10, 10, 10, 10, 10, 10, 10, 10,
+10, 10,  9,  9,  9,  9,  9,  9,
+ 9,  9,  9,  9,  9,  9,  9,  9,
+ 9,  9,  9,  9,  9,  9,  9,  9,
+ 9,  9,  9,  9,  9,  9,  9,  9,
+ 9,  9,  9,  9,  9,  9,  9,  9,
+ 9,  9,  9,  9,  9,  8,  8,  8,
+ 8,  8,  8,  8,  8,  8,  8,  8,
+ 8,  8,  8,  8,  8,  8,  8,  8,
+ 8,  8,  8,  8,  7,  7,  7,  7,
+ 7,  7,  7,  7,  7,  7,  7,  7,
+ 7,  6,  6,  6,  6,  6,  6,  6,
+ 5,  5,  5,  5,  5,  4,  4,  3,
+ 3,  2
+};
+
+#define BITS_OF_4SQRT_OF_P 512
+#define LARGE_L 983
+// The l_i's are only required for isogeny constructions
+#endif /* Addition chains */
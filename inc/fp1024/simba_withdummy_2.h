@@ -0,0 +1,97 @@
+#ifndef _SIMBA_PARAMETERS_H_
+#define _SIMBA_PARAMETERS_H_
+
+// Generated by tools/csidh_params.py
+
+// SIMBA-(NUMBER_OF_BATCHES)-MY
+#define NUMBER_OF_BATCHES 3
+#define MY 8
+
+// (each entry corresponds to the number of degree-(l_i) to be required in the action: uniform, key space of (2B + 1)^N)
+static int8_t B[] =	{
+ 2,  2,  2,  2,  2,  2,  2,  2,
+ 2,  2,  2,  2,  2,  2,  2,  2,
+ 2,  2,  2,  2,  2,  2,  2,  2,
+ 2,  2,  2,  2,  2,  2,  2,  2,
+ 2,  2,  2,  2,  2,  2,  2,  2,
+ 2,  2,  2,  2,  2,  2,  2,  2,
+ 2,  2,  2,  2,  2,  2,  2,  2,
+ 2,  2,  2,  2,  2,  2,  2,  2,
+ 2,  2,  2,  2,  2,  2,  2,  2,
+ 2,  2,  2,  2,  2,  2,  2,  2,
+ 2,  2,  2,  2,  2,  2,  2,  2,
+ 2,  2,  2,  2,  2,  2,  2,  2,
+ 2,  2,  2,  2,  2,  2,  2,  2,
+ 2,  2,  2,  2,  2,  2,  2,  2,
+ 2,  2,  2,  2,  2,  2,  2,  2,
+ 2,  2,  2,  2,  2,  2,  2,  2,
+ 2,  2
+};
+
+// (NUMBER_OF_BATCHES) different subsets (i.e., batches)
+static uint8_t BATCH_0[] = { 0, 3, 6, 9, 12, 15, 18, 21, 24, 27, 30, 33, 36, 39, 42, 45, 48, 51, 54, 57, 60, 63, 66, 69, 72, 75, 78, 81, 84, 87, 90, 93, 96, 99, 102, 105, 108, 111, 114, 117, 120, 123, 126, 129 };
+static uint8_t BATCH_1[] = { 1, 4, 7, 10, 13, 16, 19, 22, 25, 28, 31, 34, 37, 40, 43, 46, 49, 52, 55, 58, 61, 64, 67, 70, 73, 76, 79, 82, 85, 88, 91, 94, 97, 100, 103, 106, 109, 112, 115, 118, 121, 124, 127 };
+static uint8_t BATCH_2[] = { 2, 5, 8, 11, 14, 17, 20, 23, 26, 29, 32, 35, 38, 41, 44, 47, 50, 53, 56, 59, 62, 65, 68, 71, 74, 77, 80, 83, 86, 89, 92, 95, 98, 101, 104, 107, 110, 113, 116, 119, 122, 125, 128 };
+
+static uint8_t SIZE_OF_EACH_BATCH[NUMBER_OF_BATCHES] = {44, 43, 43};
+static uint8_t *BATCHES[NUMBER_OF_BATCHES] = { BATCH_0, BATCH_1, BATCH_2 };
+
+static uint8_t LAST_ISOGENY[NUMBER_OF_BATCHES] = { 129, 127, 128 };
+static uint16_t NUMBER_OF_ISOGENIES = 260;
+
+// The complement of each batch
+static uint8_t SIZE_OF_EACH_COMPLEMENT_BATCH[NUMBER_OF_BATCHES] = {86, 87, 87};
+static uint8_t COMPLEMENT_OF_EACH_BATCH[NUMBER_OF_BATCHES][N] = {
+{   1,   2,   4,   5,   7,   8,  10,  11,
+ 13,  14,  16,  17,  19,  20,  22,  23,
+ 25,  26,  28,  29,  31,  32,  34,  35,
+ 37,  38,  40,  41,  43,  44,  46,  47,
+ 49,  50,  52,  53,  55,  56,  58,  59,
+ 61,  62,  64,  65,  67,  68,  70,  71,
+ 73,  74,  76,  77,  79,  80,  82,  83,
+ 85,  86,  88,  89,  91,  92,  94,  95,
+ 97,  98, 100, 101, 103, 104, 106, 107,
+109, 110, 112, 113, 115, 116, 118, 119,
+121, 122, 124, 125, 127, 128, 130, 130,
+130, 130, 130, 130, 130, 130, 130, 130,
+130, 130, 130, 130, 130, 130, 130, 130,
+130, 130, 130, 130, 130, 130, 130, 130,
+130, 130, 130, 130, 130, 130, 130, 130,
+130, 130, 130, 130, 130, 130, 130, 130,
+130, 130 },
+{   0,   2,   3,   5,   6,   8,   9,  11,
+ 12,  14,  15,  17,  18,  20,  21,  23,
+ 24,  26,  27,  29,  30,  32,  33,  35,
+ 36,  38,  39,  41,  42,  44,  45,  47,
+ 48,  50,  51,  53,  54,  56,  57,  59,
+ 60,  62,  63,  65,  66,  68,  69,  71,
+ 72,  74,  75,  77,  78,  80,  81,  83,
+ 84,  86,  87,  89,  90,  92,  93,  95,
+ 96,  98,  99, 101, 102, 104, 105, 107,
+108, 110, 111, 113, 114, 116, 117, 119,
+120, 122, 123, 125, 126, 128, 129, 130,
+130, 130, 130, 130, 130, 130, 130, 130,
+130, 130, 130, 130, 130, 130, 130, 130,
+130, 130, 130, 130, 130, 130, 130, 130,
+130, 130, 130, 130, 130, 130, 130, 130,
+130, 130, 130, 130, 130, 130, 130, 130,
+130, 130 },
+{   0,   1,   3,   4,   6,   7,   9,  10,
+ 12,  13,  15,  16,  18,  19,  21,  22,
+ 24,  25,  27,  28,  30,  31,  33,  34,
+ 36,  37,  39,  40,  42,  43,  45,  46,
+ 48,  49,  51,  52,  54,  55,  57,  58,
+ 60,  61,  63,  64,  66,  67,  69,  70,
+ 72,  73,  75,  76,  78,  79,  81,  82,
+ 84,  85,  87,  88,  90,  91,  93,  94,
+ 96,  97,  99, 100, 102, 103, 105, 106,
+108, 109, 111, 112, 114, 115, 117, 118,
+120, 121, 123, 124, 126, 127, 129, 130,
+130, 130, 130, 130, 130, 130, 130, 130,
+130, 130, 130, 130, 130, 130, 130, 130,
+130, 130, 130, 130, 130, 130, 130, 130,
+130, 130, 130, 130, 130, 130, 130, 130,
+130, 130, 130, 130, 130, 130, 130, 130,
+130, 130 }
+};
+#endif
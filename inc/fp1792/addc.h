@@ -0,0 +1,135 @@
+#ifndef _ADDC_H_
+#define _ADDC_H_
+
+// Generated by tools/csidh_params.py
+
+// The public Edward's curve with coefficients a and b. E is isomorphic to E' / F_p : y^2 = x^3 + x
+// a and (a - d) in Montgomery domain represetantion 
+static proj E = {
+{ 0xAC65D2457A031468, 0x67F95270533339ED, 0x66DDE2F7B82C2045, 0xC49EE1921D95FAF5, 0xFAC025A759480C9D, 0x414AAAF84152FF8, 0x80E3DA869647EAC6, 0x573CA83502F95896, 0xF705EB5B86CE51A0, 0x24F161205E9370D1, 0xE1BB94C9B2B9B714, 0xFCA6440216B41D5D, 0x3923FFE7B23A86B, 0xA1E3FFE9943A8009, 0xC81CC73D39410348, 0xCF459740E1AB623E, 0x82E3C25A52CD9F0C, 0x9526C494D45981DC, 0x27204A786115E0A7, 0x97042FD448E088F7, 0x6C46BDA9B18D7122, 0x31559D0C0404295B, 0x772FC0A4CD89726E, 0xE08913A57DE88C33, 0x7C16A4AB8568EAC8, 0xE3BAC0D8123DBD29, 0x854926EA3544F807, 0x38773790AE85F51},	// a
+{ 0x58CBA48AF40628D0, 0xCFF2A4E0A66673DB, 0xCDBBC5EF7058408A, 0x893DC3243B2BF5EA, 0xF5804B4EB290193B, 0x829555F082A5FF1, 0x1C7B50D2C8FD58C, 0xAE79506A05F2B12D, 0xEE0BD6B70D9CA340, 0x49E2C240BD26E1A3, 0xC377299365736E28, 0xF94C88042D683ABB, 0x7247FFCF64750D7, 0x43C7FFD328750012, 0x90398E7A72820691, 0x9E8B2E81C356C47D, 0x5C784B4A59B3E19, 0x2A4D8929A8B303B9, 0x4E4094F0C22BC14F, 0x2E085FA891C111EE, 0xD88D7B53631AE245, 0x62AB3A18080852B6, 0xEE5F81499B12E4DC, 0xC112274AFBD11866, 0xF82D49570AD1D591, 0xC77581B0247B7A52, 0xA924DD46A89F00F, 0x70EE6F215D0BEA3}	// a - d
+};
+
+// Shortest differential addition chains for each l_i
+static uint64_t ADDITION_CHAIN[] = {
+0x2510, 0x2614, 0x210, 0x120, 0x4E0, 0x2B54, 0x12E0, 0xE40,
+0x2A0, 0x1080, 0x540, 0x2B80, 0xA04, 0xA40, 0x450, 0x504,
+0x4A0, 0x910, 0x890, 0x10A0, 0x3650, 0x8A8, 0x484, 0x1110,
+0x950, 0x2C0, 0x160, 0x2B88, 0xC40, 0xC08, 0xC10, 0x830,
+0x860, 0xC80, 0x1142, 0x980, 0x1A00, 0x610, 0x1448, 0x190,
+0x1180, 0x1018, 0x10C0, 0xA30, 0x1880, 0xCA0, 0x148A, 0xD50,
+0x11A0, 0x1A80, 0xD80, 0x1430, 0xE00, 0x14C0, 0x380, 0x40,
+0x1C0, 0x200, 0x14B0, 0x1308, 0x14D0, 0xB80, 0x5C0, 0xA64,
+0x1A90, 0x16C0, 0xC68, 0x8E0, 0x1C00, 0xEA0, 0x208, 0x240,
+0xE90, 0x1B08, 0x1360, 0x1980, 0x508, 0xE50, 0x600, 0x148,
+0x290, 0x80A, 0x828, 0x680, 0x580, 0x1A0, 0xD0, 0x620,
+0x904, 0x920, 0xA50, 0x5A0, 0x88A, 0xD00, 0x320, 0x588,
+0xB40, 0x4B0, 0x2C4, 0x912, 0xC20, 0xB10, 0x328, 0xA18,
+0x960, 0x700, 0x6A4, 0x80, 0xCA0, 0x1D0, 0x400, 0xB60,
+0x140, 0x220, 0x720, 0x500, 0xE80, 0x408, 0x150, 0xD90,
+0x214, 0x144, 0xC0, 0xEA0, 0x248, 0x520, 0x5D8, 0x444,
+0x50A, 0x528, 0x320, 0xC8, 0x130, 0x5A0, 0x268, 0x4C0,
+0x640, 0x590, 0x5A8, 0x4D0, 0x20, 0x6A8, 0x140, 0x50,
+0xA0, 0x108, 0x202, 0x240, 0x148, 0x2A0, 0x288, 0x228,
+0x250, 0x242, 0x118, 0x340, 0x162, 0x0, 0x310, 0x260,
+0x2C4, 0x314, 0x100, 0xE8, 0x82, 0x88, 0xA8, 0x110,
+0xC0, 0x60, 0xD0, 0x180, 0x98, 0x1A0, 0x184, 0x190,
+0x40, 0x70, 0x1D0, 0x84, 0x60, 0x30, 0x68, 0xC0,
+0x0, 0x6C, 0x10, 0x14, 0x50, 0x48, 0x2C, 0x58,
+0x4C, 0x20, 0x22, 0x18, 0x30, 0x8, 0x10, 0x18,
+0x4, 0xA, 0x0, 0x4, 0x2, 0x0, 0x0
+};
+
+// Length of the shortest differential addition chain for each l_i
+static uint8_t ADDITION_CHAIN_LENGTH[] = {
+14, 14, 13, 13, 14, 14, 14, 14,
+13, 13, 13, 14, 13, 13, 13, 13,
+13, 13, 13, 13, 14, 13, 13, 13,
+13, 13, 13, 14, 13, 13, 13, 13,
+13, 13, 13, 13, 13, 13, 13, 13,
+13, 13, 13, 13, 13, 13, 13, 13,
+13, 13, 13, 13, 13, 13, 13, 12,
+13, 12, 13, 13, 13, 13, 13, 13,
+13, 13, 13, 13, 13, 13, 12, 12,
+13, 13, 13, 13, 12, 13, 12, 12,
+12, 12, 12, 12, 12, 12, 12, 12,
+12, 12, 12, 12, 12, 12, 12, 12,
+12, 12, 12, 12, 12, 12, 12, 12,
+12, 12, 12, 11, 12, 12, 11, 12,
+11, 11, 12, 11, 12, 11, 11, 12,
+11, 11, 11, 12, 11, 11, 12, 11,
+11, 11, 11, 11, 11, 11, 11, 11,
+11, 11, 11, 11, 10, 11, 10, 10,
+10, 10, 10, 10, 10, 10, 10, 10,
+10, 10, 10, 10, 10,  9, 10, 10,
+10, 10,  9, 10,  9,  9,  9,  9,
+ 9,  9,  9,  9,  9,  9,  9,  9,
+ 8,  9,  9,  8,  8,  8,  8,  8,
+ 7,  8,  7,  7,  7,  7,  7,  7,
+ 7,  6,  6,  6,  6,  5,  5,  5,
+ 4,  4,  3,  3,  2,  1,  0
+};
+
+// L
+static uint32_t L[] = { 
+1619, 1279, 1277, 1259, 1249, 1237, 1231, 1229,
+1223, 1217, 1213, 1201, 1193, 1187, 1181, 1171,
+1163, 1153, 1151, 1129, 1123, 1117, 1109, 1103,
+1097, 1093, 1091, 1087, 1069, 1063, 1061, 1051,
+1049, 1039, 1033, 1031, 1021, 1019, 1013, 1009,
+997, 991, 983, 977, 971, 967, 953, 947,
+941, 937, 929, 919, 911, 907, 887, 883,
+881, 877, 863, 859, 857, 853, 839, 829,
+827, 823, 821, 811, 809, 797, 787, 773,
+769, 761, 757, 751, 743, 739, 733, 727,
+719, 709, 701, 691, 683, 677, 673, 661,
+659, 653, 647, 643, 641, 631, 619, 617,
+613, 607, 601, 599, 593, 587, 577, 571,
+569, 563, 557, 547, 541, 523, 521, 509,
+503, 499, 491, 487, 479, 467, 463, 461,
+457, 449, 443, 439, 433, 431, 421, 419,
+409, 401, 397, 389, 383, 379, 373, 367,
+359, 353, 349, 347, 337, 331, 317, 313,
+311, 307, 293, 283, 281, 277, 271, 269,
+263, 257, 251, 241, 239, 233, 229, 227,
+223, 211, 199, 197, 193, 191, 181, 179,
+173, 167, 163, 157, 151, 149, 139, 137,
+131, 127, 113, 109, 107, 103, 101,  97,
+ 89,  83,  79,  73,  71,  67,  61,  59,
+ 53,  47,  43,  41,  37,  31,  29,  23,
+ 19,  17,  13,  11,   7,   5,   3
+};
+
+static uint16_t BITS_OF_L[] = { 
+11, 11, 11, 11, 11, 11, 11, 11,
+11, 11, 11, 11, 11, 11, 11, 11,
+11, 11, 11, 11, 11, 11, 11, 11,
+11, 11, 11, 11, 11, 11, 11, 11,
+11, 11, 11, 11, 10, 10, 10, 10,
+10, 10, 10, 10, 10, 10, 10, 10,
+10, 10, 10, 10, 10, 10, 10, 10,
+10, 10, 10, 10, 10, 10, 10, 10,
+10, 10, 10, 10, 10, 10, 10, 10,
+10, 10, 10, 10, 10, 10, 10, 10,
+10, 10, 10, 10, 10, 10, 10, 10,
+10, 10, 10, 10, 10, 10, 10, 10,
+10, 10, 10, 10, 10, 10, 10, 10,
+10, 10, 10, 10, 10, 10, 10,  9,
+ 9,  9,  9,  9,  9,  9,  9,  9,
+ 9,  9,  9,  9,  9,  9,  9,  9,
+ 9,  9,  9,  9,  9,  9,  9,  9,
+ 9,  9,  9,  9,  9,  9,  9,  9,
+ 9,  9,  9,  9,  9,  9,  9,  9,
+ 9,  9,  8,  8,  8,  8,  8,  8,
+ 8,  8,  8,  8,  8,  8,  8,  8,
+ 8,  8,  8,  8,  8,  8,  8,  8,
+ 8,  7,  7,  7,  7,  7,  7,  7,
+ 7,  7,  7,  7,  7,  7,  6,  6,
+ 6,  6,  6,  6,  6,  5,  5,  5,
+ 5,  5,  4,  4,  3,  3,  2
+};
+
+#define BITS_OF_4SQRT_OF_P 896
+#define LARGE_L 1619
+// The l_i's are only required for isogeny constructions
+#endif /* Addition chains */
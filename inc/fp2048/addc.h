@@ -0,0 +1,147 @@
+#ifndef _ADDC_H_
+#define _ADDC_H_
+
+// Generated by tools/csidh_params.py
+
+// The public Edward's curve with coefficients a and b. E is isomorphic to E' / F_p : y^2 = x^3 + x
+// a and (a - d) in Montgomery domain represetantion 
+static proj E = {
+{ 0x1EBD0267AF173076, 0x5CF435C97F22ADE8, 0x7CC07262D74F923C, 0x3A1393BAD6E83E58, 0x8582A12FA164B45B, 0xA83C55767B15C012, 0x40280851B343FD33, 0xC447B44E0B548B73, 0x292506AAB54AE2E4, 0x6E01D7219BA12896, 0x9A2493C1BFD0ABA6, 0xF48E1F9537216A53, 0xAD5F9DA8A6FDC005, 0x860AE708F1791CD4, 0x49D1632D90BA5C8E, 0xB65A9431DBA4B482, 0xA6C94ECC549F2A82, 0x938FAA820E5F56B8, 0xDBAA68C7B0B523BE, 0x7F58C6490A3DF18C, 0x53E0FBC95365E96F, 0xD30CF134421D2B36, 0xE598179F5C614E82, 0xF755A483E00A2910, 0x57A3B7F21E16A727, 0xF35A823BA076D6D1, 0xA0A2CD412C7DA5D6, 0x2DEDC686F5C4A88E, 0xC89669680B37BF64, 0xC81C4ADC7ADDF308, 0xA78B0D308421B12, 0x10743263AC4A5D},	// a
+{ 0x3D7A04CF5E2E60EC, 0xB9E86B92FE455BD0, 0xF980E4C5AE9F2478, 0x74272775ADD07CB0, 0xB05425F42C968B6, 0x5078AAECF62B8025, 0x805010A36687FA67, 0x888F689C16A916E6, 0x524A0D556A95C5C9, 0xDC03AE433742512C, 0x344927837FA1574C, 0xE91C3F2A6E42D4A7, 0x5ABF3B514DFB800B, 0xC15CE11E2F239A9, 0x93A2C65B2174B91D, 0x6CB52863B7496904, 0x4D929D98A93E5505, 0x271F55041CBEAD71, 0xB754D18F616A477D, 0xFEB18C92147BE319, 0xA7C1F792A6CBD2DE, 0xA619E268843A566C, 0xCB302F3EB8C29D05, 0xEEAB4907C0145221, 0xAF476FE43C2D4E4F, 0xE6B5047740EDADA2, 0x41459A8258FB4BAD, 0x5BDB8D0DEB89511D, 0x912CD2D0166F7EC8, 0x903895B8F5BBE611, 0x14F161A610843625, 0x20E864C75894BA}	// a - d
+};
+
+// Shortest differential addition chains for each l_i
+static uint64_t ADDITION_CHAIN[] = {
+0x4C40, 0x800, 0x648, 0x1350, 0x2AC0, 0x20C4, 0x80, 0x100,
+0x2C50, 0x2260, 0x3540, 0x2A30, 0xB60, 0xDA0, 0x3510, 0x280,
+0x1C08, 0x1B20, 0x1630, 0x808, 0x820, 0x840, 0x804, 0x1D40,
+0x900, 0x2614, 0x210, 0x120, 0x4E0, 0x2B54, 0x12E0, 0xE40,
+0x2A0, 0x1080, 0x540, 0x2B80, 0xA04, 0xA40, 0x450, 0x504,
+0x4A0, 0x910, 0x890, 0x10A0, 0x3650, 0x8A8, 0x484, 0x1110,
+0x950, 0x2C0, 0x160, 0x2B88, 0xC40, 0xC08, 0xC10, 0x830,
+0x860, 0xC80, 0x1142, 0x980, 0x1A00, 0x610, 0x1448, 0x190,
+0x1180, 0x1018, 0x10C0, 0xA30, 0x1880, 0xCA0, 0x148A, 0xD50,
+0x11A0, 0x1A80, 0xD80, 0x1430, 0xE00, 0x14C0, 0x380, 0x40,
+0x1C0, 0x200, 0x14B0, 0x1308, 0x14D0, 0xB80, 0x5C0, 0xA64,
+0x1A90, 0x16C0, 0xC68, 0x8E0, 0x1C00, 0xEA0, 0x208, 0x240,
+0xE90, 0x1B08, 0x1360, 0x1980, 0x508, 0xE50, 0x600, 0x148,
+0x290, 0x80A, 0x828, 0x680, 0x580, 0x1A0, 0xD0, 0x620,
+0x904, 0x920, 0xA50, 0x5A0, 0x88A, 0xD00, 0x320, 0x588,
+0xB40, 0x4B0, 0x2C4, 0x912, 0xC20, 0xB10, 0x328, 0xA18,
+0x960, 0x700, 0x6A4, 0x80, 0xCA0, 0x1D0, 0x400, 0xB60,
+0x140, 0x220, 0x720, 0x500, 0xE80, 0x408, 0x150, 0xD90,
+0x214, 0x144, 0xC0, 0xEA0, 0x248, 0x520, 0x5D8, 0x444,
+0x50A, 0x528, 0x320, 0xC8, 0x130, 0x5A0, 0x268, 0x4C0,
+0x640, 0x590, 0x5A8, 0x4D0, 0x20, 0x6A8, 0x140, 0x50,
+0xA0, 0x108, 0x202, 0x240, 0x148, 0x2A0, 0x288, 0x228,
+0x250, 0x242, 0x118, 0x340, 0x162, 0x0, 0x310, 0x260,
+0x2C4, 0x314, 0x100, 0xE8, 0x82, 0x88, 0xA8, 0x110,
+0xC0, 0x60, 0xD0, 0x180, 0x98, 0x1A0, 0x184, 0x190,
+0x40, 0x70, 0x1D0, 0x84, 0x60, 0x30, 0x68, 0xC0,
+0x0, 0x6C, 0x10, 0x14, 0x50, 0x48, 0x2C, 0x58,
+0x4C, 0x20, 0x22, 0x18, 0x30, 0x8, 0x10, 0x18,
+0x4, 0xA, 0x0, 0x4, 0x2, 0x0, 0x0
+};
+
+// Length of the shortest differential addition chain for each l_i
+static uint8_t ADDITION_CHAIN_LENGTH[] = {
+15, 13, 14, 14, 14, 14, 13, 13,
+14, 14, 14, 14, 14, 14, 14, 13,
+14, 14, 14, 13, 13, 13, 13, 14,
+13, 14, 13, 13, 14, 14, 14, 14,
+13, 13, 13, 14, 13, 13, 13, 13,
+13, 13, 13, 13, 14, 13, 13, 13,
+13, 13, 13, 14, 13, 13, 13, 13,
+13, 13, 13, 13, 13, 13, 13, 13,
+13, 13, 13, 13, 13, 13, 13, 13,
+13, 13, 13, 13, 13, 13, 13, 12,
+13, 12, 13, 13, 13, 13, 13, 13,
+13, 13, 13, 13, 13, 13, 12, 12,
+13, 13, 13, 13, 12, 13, 12, 12,
+12, 12, 12, 12, 12, 12, 12, 12,
+12, 12, 12, 12, 12, 12, 12, 12,
+12, 12, 12, 12, 12, 12, 12, 12,
+12, 12, 12, 11, 12, 12, 11, 12,
+11, 11, 12, 11, 12, 11, 11, 12,
+11, 11, 11, 12, 11, 11, 12, 11,
+11, 11, 11, 11, 11, 11, 11, 11,
+11, 11, 11, 11, 10, 11, 10, 10,
+10, 10, 10, 10, 10, 10, 10, 10,
+10, 10, 10, 10, 10,  9, 10, 10,
+10, 10,  9, 10,  9,  9,  9,  9,
+ 9,  9,  9,  9,  9,  9,  9,  9,
+ 8,  9,  9,  8,  8,  8,  8,  8,
+ 7,  8,  7,  7,  7,  7,  7,  7,
+ 7,  6,  6,  6,  6,  5,  5,  5,
+ 4,  4,  3,  3,  2,  1,  0
+};
+
+// L
+static uint32_t L[] = { 
+2269, 1453, 1451, 1447, 1439, 1433, 1429, 1427,
+1423, 1409, 1399, 1381, 1373, 1367, 1361, 1327,
+1321, 1319, 1307, 1303, 1301, 1297, 1291, 1289,
+1283, 1279, 1277, 1259, 1249, 1237, 1231, 1229,
+1223, 1217, 1213, 1201, 1193, 1187, 1181, 1171,
+1163, 1153, 1151, 1129, 1123, 1117, 1109, 1103,
+1097, 1093, 1091, 1087, 1069, 1063, 1061, 1051,
+1049, 1039, 1033, 1031, 1021, 1019, 1013, 1009,
+997, 991, 983, 977, 971, 967, 953, 947,
+941, 937, 929, 919, 911, 907, 887, 883,
+881, 877, 863, 859, 857, 853, 839, 829,
+827, 823, 821, 811, 809, 797, 787, 773,
+769, 761, 757, 751, 743, 739, 733, 727,
+719, 709, 701, 691, 683, 677, 673, 661,
+659, 653, 647, 643, 641, 631, 619, 617,
+613, 607, 601, 599, 593, 587, 577, 571,
+569, 563, 557, 547, 541, 523, 521, 509,
+503, 499, 491, 487, 479, 467, 463, 461,
+457, 449, 443, 439, 433, 431, 421, 419,
+409, 401, 397, 389, 383, 379, 373, 367,
+359, 353, 349, 347, 337, 331, 317, 313,
+311, 307, 293, 283, 281, 277, 271, 269,
+263, 257, 251, 241, 239, 233, 229, 227,
+223, 211, 199, 197, 193, 191, 181, 179,
+173, 167, 163, 157, 151, 149, 139, 137,
+131, 127, 113, 109, 107, 103, 101,  97,
+ 89,  83,  79,  73,  71,  67,  61,  59,
+ 53,  47,  43,  41,  37,  31,  29,  23,
+ 19,  17,  13,  11,   7,   5,   3
+};
+
+static uint16_t BITS_OF_L[] = { 
+12, 11, 11, 11, 11, 11, 11, 11,
+11, 11, 11, 11, 11, 11, 11, 11,
+11, 11, 11, 11, 11, 11, 11, 11,
+11, 11, 11, 11, 11, 11, 11, 11,
+11, 11, 11, 11, 11, 11, 11, 11,
+11, 11, 11, 11, 11, 11, 11, 11,
+11, 11, 11, 11, 11, 11, 11, 11,
+11, 11, 11, 11, 10, 10, 10, 10,
+10, 10, 10, 10, 10, 10, 10, 10,
+10, 10, 10, 10, 10, 10, 10, 10,
+10, 10, 10, 10, 10, 10, 10, 10,
+10, 10, 10, 10, 10, 10, 10, 10,
+10, 10, 10, 10, 10, 10, 10, 10,
+10, 10, 10, 10, 10, 10, 10, 10,
+10, 10, 10, 10, 10, 10, 10, 10,
+10, 10, 10, 10, 10, 10, 10, 10,
+10, 10, 10, 10, 10, 10, 10,  9,
+ 9,  9,  9,  9,  9,  9,  9,  9,
+ 9,  9,  9,  9,  9,  9,  9,  9,
+ 9,  9,  9,  9,  9,  9,  9,  9,
+ 9,  9,  9,  9,  9,  9,  9,  9,
+ 9,  9,  9,  9,  9,  9,  9,  9,
+ 9,  9,  8,  8,  8,  8,  8,  8,
+ 8,  8,  8,  8,  8,  8,  8,  8,
+ 8,  8,  8,  8,  8,  8,  8,  8,
+ 8,  7,  7,  7,  7,  7,  7,  7,
+ 7,  7,  7,  7,  7,  7,  6,  6,
+ 6,  6,  6,  6,  6,  5,  5,  5,
+ 5,  5,  4,  4,  3,  3,  2
+};
+
+#define BITS_OF_4SQRT_OF_P 1021
+#define LARGE_L 2269
+// The l_i's are only required for isogeny constructions
+#endif /* Addition chains */
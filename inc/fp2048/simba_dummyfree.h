@@ -0,0 +1,205 @@
+#ifndef _SIMBA_PARAMETERS_H_
+#define _SIMBA_PARAMETERS_H_
+
+// Generated by tools/csidh_params.py
+
+// SIMBA-(NUMBER_OF_BATCHES)-MY
+#define NUMBER_OF_BATCHES 5
+#define MY 11
+
+// (each entry corresponds to the number of degree-(l_i) to be required in the action: uniform, dummy-free key space of (B + 1)^N)
+static int8_t B[] =	{
+ 2,  2,  2,  2,  2,  2,  2,  2,
+ 2,  2,  2,  2,  2,  2,  2,  2,
+ 2,  2,  2,  2,  2,  2,  2,  2,
+ 2,  2,  2,  2,  2,  2,  2,  2,
+ 2,  2,  2,  2,  2,  2,  2,  2,
+ 2,  2,  2,  2,  2,  2,  2,  2,
+ 2,  2,  2,  2,  2,  2,  2,  2,
+ 2,  2,  2,  2,  2,  2,  2,  2,
+ 2,  2,  2,  2,  2,  2,  2,  2,
+ 2,  2,  2,  2,  2,  2,  2,  2,
+ 2,  2,  2,  2,  2,  2,  2,  2,
+ 2,  2,  2,  2,  2,  2,  2,  2,
+ 2,  2,  2,  2,  2,  2,  2,  2,
+ 2,  2,  2,  2,  2,  2,  2,  2,
+ 2,  2,  2,  2,  2,  2,  2,  2,
+ 2,  2,  2,  2,  2,  2,  2,  2,
+ 2,  2,  2,  2,  2,  2,  2,  2,
+ 2,  2,  2,  2,  2,  2,  2,  2,
+ 2,  2,  2,  2,  2,  2,  2,  2,
+ 2,  2,  2,  2,  2,  2,  2,  2,
+ 2,  2,  2,  2,  2,  2,  2,  2,
+ 2,  2,  2,  2,  2,  2,  2,  2,
+ 2,  2,  2,  2,  2,  2,  2,  2,
+ 2,  2,  2,  2,  2,  2,  2,  2,
+ 2,  2,  2,  2,  2,  2,  2,  2,
+ 2,  2,  2,  2,  2,  2,  2,  2,
+ 2,  2,  2,  2,  2,  2,  2,  2,
+ 2,  2,  2,  2,  2,  2,  2,  2,
+ 2,  2,  2,  2,  2,  2,  2
+};
+
+// (NUMBER_OF_BATCHES) different subsets (i.e., batches)
+static uint8_t BATCH_0[] = { 0, 5, 10, 15, 20, 25, 30, 35, 40, 45, 50, 55, 60, 65, 70, 75, 80, 85, 90, 95, 100, 105, 110, 115, 120, 125, 130, 135, 140, 145, 150, 155, 160, 165, 170, 175, 180, 185, 190, 195, 200, 205, 210, 215, 220, 225, 230 };
+static uint8_t BATCH_1[] = { 1, 6, 11, 16, 21, 26, 31, 36, 41, 46, 51, 56, 61, 66, 71, 76, 81, 86, 91, 96, 101, 106, 111, 116, 121, 126, 131, 136, 141, 146, 151, 156, 161, 166, 171, 176, 181, 186, 191, 196, 201, 206, 211, 216, 221, 226 };
+static uint8_t BATCH_2[] = { 2, 7, 12, 17, 22, 27, 32, 37, 42, 47, 52, 57, 62, 67, 72, 77, 82, 87, 92, 97, 102, 107, 112, 117, 122, 127, 132, 137, 142, 147, 152, 157, 162, 167, 172, 177, 182, 187, 192, 197, 202, 207, 212, 217, 222, 227 };
+static uint8_t BATCH_3[] = { 3, 8, 13, 18, 23, 28, 33, 38, 43, 48, 53, 58, 63, 68, 73, 78, 83, 88, 93, 98, 103, 108, 113, 118, 123, 128, 133, 138, 143, 148, 153, 158, 163, 168, 173, 178, 183, 188, 193, 198, 203, 208, 213, 218, 223, 228 };
+static uint8_t BATCH_4[] = { 4, 9, 14, 19, 24, 29, 34, 39, 44, 49, 54, 59, 64, 69, 74, 79, 84, 89, 94, 99, 104, 109, 114, 119, 124, 129, 134, 139, 144, 149, 154, 159, 164, 169, 174, 179, 184, 189, 194, 199, 204, 209, 214, 219, 224, 229 };
+
+static uint8_t SIZE_OF_EACH_BATCH[NUMBER_OF_BATCHES] = {47, 46, 46, 46, 46};
+static uint8_t *BATCHES[NUMBER_OF_BATCHES] = { BATCH_0, BATCH_1, BATCH_2, BATCH_3, BATCH_4 };
+
+static uint8_t LAST_ISOGENY[NUMBER_OF_BATCHES] = { 230, 226, 227, 228, 229 };
+static uint16_t NUMBER_OF_ISOGENIES = 462;
+
+// The complement of each batch
+static uint8_t SIZE_OF_EACH_COMPLEMENT_BATCH[NUMBER_OF_BATCHES] = {184, 185, 185, 185, 185};
+static uint8_t COMPLEMENT_OF_EACH_BATCH[NUMBER_OF_BATCHES][N] = {
+{   1,   2,   3,   4,   6,   7,   8,   9,
+ 11,  12,  13,  14,  16,  17,  18,  19,
+ 21,  22,  23,  24,  26,  27,  28,  29,
+ 31,  32,  33,  34,  36,  37,  38,  39,
+ 41,  42,  43,  44,  46,  47,  48,  49,
+ 51,  52,  53,  54,  56,  57,  58,  59,
+ 61,  62,  63,  64,  66,  67,  68,  69,
+ 71,  72,  73,  74,  76,  77,  78,  79,
+ 81,  82,  83,  84,  86,  87,  88,  89,
+ 91,  92,  93,  94,  96,  97,  98,  99,
+101, 102, 103, 104, 106, 107, 108, 109,
+111, 112, 113, 114, 116, 117, 118, 119,
+121, 122, 123, 124, 126, 127, 128, 129,
+131, 132, 133, 134, 136, 137, 138, 139,
+141, 142, 143, 144, 146, 147, 148, 149,
+151, 152, 153, 154, 156, 157, 158, 159,
+161, 162, 163, 164, 166, 167, 168, 169,
+171, 172, 173, 174, 176, 177, 178, 179,
+181, 182, 183, 184, 186, 187, 188, 189,
+191, 192, 193, 194, 196, 197, 198, 199,
+201, 202, 203, 204, 206, 207, 208, 209,
+211, 212, 213, 214, 216, 217, 218, 219,
+221, 222, 223, 224, 226, 227, 228, 229,
+231, 231, 231, 231, 231, 231, 231, 231,
+231, 231, 231, 231, 231, 231, 231, 231,
+231, 231, 231, 231, 231, 231, 231, 231,
+231, 231, 231, 231, 231, 231, 231, 231,
+231, 231, 231, 231, 231, 231, 231, 231,
+231, 231, 231, 231, 231, 231, 231 },
+{   0,   2,   3,   4,   5,   7,   8,   9,
+ 10,  12,  13,  14,  15,  17,  18,  19,
+ 20,  22,  23,  24,  25,  27,  28,  29,
+ 30,  32,  33,  34,  35,  37,  38,  39,
+ 40,  42,  43,  44,  45,  47,  48,  49,
+ 50,  52,  53,  54,  55,  57,  58,  59,
+ 60,  62,  63,  64,  65,  67,  68,  69,
+ 70,  72,  73,  74,  75,  77,  78,  79,
+ 80,  82,  83,  84,  85,  87,  88,  89,
+ 90,  92,  93,  94,  95,  97,  98,  99,
+100, 102, 103, 104, 105, 107, 108, 109,
+110, 112, 113, 114, 115, 117, 118, 119,
+120, 122, 123, 124, 125, 127, 128, 129,
+130, 132, 133, 134, 135, 137, 138, 139,
+140, 142, 143, 144, 145, 147, 148, 149,
+150, 152, 153, 154, 155, 157, 158, 159,
+160, 162, 163, 164, 165, 167, 168, 169,
+170, 172, 173, 174, 175, 177, 178, 179,
+180, 182, 183, 184, 185, 187, 188, 189,
+190, 192, 193, 194, 195, 197, 198, 199,
+200, 202, 203, 204, 205, 207, 208, 209,
+210, 212, 213, 214, 215, 217, 218, 219,
+220, 222, 223, 224, 225, 227, 228, 229,
+230, 231, 231, 231, 231, 231, 231, 231,
+231, 231, 231, 231, 231, 231, 231, 231,
+231, 231, 231, 231, 231, 231, 231, 231,
+231, 231, 231, 231, 231, 231, 231, 231,
+231, 231, 231, 231, 231, 231, 231, 231,
+231, 231, 231, 231, 231, 231, 231 },
+{   0,   1,   3,   4,   5,   6,   8,   9,
+ 10,  11,  13,  14,  15,  16,  18,  19,
+ 20,  21,  23,  24,  25,  26,  28,  29,
+ 30,  31,  33,  34,  35,  36,  38,  39,
+ 40,  41,  43,  44,  45,  46,  48,  49,
+ 50,  51,  53,  54,  55,  56,  58,  59,
+ 60,  61,  63,  64,  65,  66,  68,  69,
+ 70,  71,  73,  74,  75,  76,  78,  79,
+ 80,  81,  83,  84,  85,  86,  88,  89,
+ 90,  91,  93,  94,  95,  96,  98,  99,
+100, 101, 103, 104, 105, 106, 108, 109,
+110, 111, 113, 114, 115, 116, 118, 119,
+120, 121, 123, 124, 125, 126, 128, 129,
+130, 131, 133, 134, 135, 136, 138, 139,
+140, 141, 143, 144, 145, 146, 148, 149,
+150, 151, 153, 154, 155, 156, 158, 159,
+160, 161, 163, 164, 165, 166, 168, 169,
+170, 171, 173, 174, 175, 176, 178, 179,
+180, 181, 183, 184, 185, 186, 188, 189,
+190, 191, 193, 194, 195, 196, 198, 199,
+200, 201, 203, 204, 205, 206, 208, 209,
+210, 211, 213, 214, 215, 216, 218, 219,
+220, 221, 223, 224, 225, 226, 228, 229,
+230, 231, 231, 231, 231, 231, 231, 231,
+231, 231, 231, 231, 231, 231, 231, 231,
+231, 231, 231, 231, 231, 231, 231, 231,
+231, 231, 231, 231, 231, 231, 231, 231,
+231, 231, 231, 231, 231, 231, 231, 231,
+231, 231, 231, 231, 231, 231, 231 },
+{   0,   1,   2,   4,   5,   6,   7,   9,
+ 10,  11,  12,  14,  15,  16,  17,  19,
+ 20,  21,  22,  24,  25,  26,  27,  29,
+ 30,  31,  32,  34,  35,  36,  37,  39,
+ 40,  41,  42,  44,  45,  46,  47,  49,
+ 50,  51,  52,  54,  55,  56,  57,  59,
+ 60,  61,  62,  64,  65,  66,  67,  69,
+ 70,  71,  72,  74,  75,  76,  77,  79,
+ 80,  81,  82,  84,  85,  86,  87,  89,
+ 90,  91,  92,  94,  95,  96,  97,  99,
+100, 101, 102, 104, 105, 106, 107, 109,
+110, 111, 112, 114, 115, 116, 117, 119,
+120, 121, 122, 124, 125, 126, 127, 129,
+130, 131, 132, 134, 135, 136, 137, 139,
+140, 141, 142, 144, 145, 146, 147, 149,
+150, 151, 152, 154, 155, 156, 157, 159,
+160, 161, 162, 164, 165, 166, 167, 169,
+170, 171, 172, 174, 175, 176, 177, 179,
+180, 181, 182, 184, 185, 186, 187, 189,
+190, 191, 192, 194, 195, 196, 197, 199,
+200, 201, 202, 204, 205, 206, 207, 209,
+210, 211, 212, 214, 215, 216, 217, 219,
+220, 221, 222, 224, 225, 226, 227, 229,
+230, 231, 231, 231, 231, 231, 231, 231,
+231, 231, 231, 231, 231, 231, 231, 231,
+231, 231, 231, 231, 231, 231, 231, 231,
+231, 231, 231, 231, 231, 231, 231, 231,
+231, 231, 231, 231, 231, 231, 231, 231,
+231, 231, 231, 231, 231, 231, 231 },
+{   0,   1,   2,   3,   5,   6,   7,   8,
+ 10,  11,  12,  13,  15,  16,  17,  18,
+ 20,  21,  22,  23,  25,  26,  27,  28,
+ 30,  31,  32,  33,  35,  36,  37,  38,
+ 40,  41,  42,  43,  45,  46,  47,  48,
+ 50,  51,  52,  53,  55,  56,  57,  58,
+ 60,  61,  62,  63,  65,  66,  67,  68,
+ 70,  71,  72,  73,  75,  76,  77,  78,
+ 80,  81,  82,  83,  85,  86,  87,  88,
+ 90,  91,  92,  93,  95,  96,  97,  98,
+100, 101, 102, 103, 105, 106, 107, 108,
+110, 111, 112, 113, 115, 116, 117, 118,
+120, 121, 122, 123, 125, 126, 127, 128,
+130, 131, 132, 133, 135, 136, 137, 138,
+140, 141, 142, 143, 145, 146, 147, 148,
+150, 151, 152, 153, 155, 156, 157, 158,
+160, 161, 162, 163, 165, 166, 167, 168,
+170, 171, 172, 173, 175, 176, 177, 178,
+180, 181, 182, 183, 185, 186, 187, 188,
+190, 191, 192, 193, 195, 196, 197, 198,
+200, 201, 202, 203, 205, 206, 207, 208,
+210, 211, 212, 213, 215, 216, 217, 218,
+220, 221, 222, 223, 225, 226, 227, 228,
+230, 231, 231, 231, 231, 231, 231, 231,
+231, 231, 231, 231, 231, 231, 231, 231,
+231, 231, 231, 231, 231, 231, 231, 231,
+231, 231, 231, 231, 231, 231, 231, 231,
+231, 231, 231, 231, 231, 231, 231, 231,
+231, 231, 231, 231, 231, 231, 231 }
+};
+#endif
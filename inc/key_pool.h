@@ -0,0 +1,26 @@
+#ifndef _KEY_POOL_H_
+#define _KEY_POOL_H_
+
+#include "edwards_curve.h"
+
+// Pool of ephemeral key pairs (sk, pk = sk * E) precomputed by background threads. Pairs are handed
+// out without locks, each one exactly once, and wiped from the pool as soon as they are taken.
+typedef struct key_pool key_pool;
+
+typedef struct {
+	uint64_t generated;	// number of key pairs computed by the background threads
+	uint64_t served;	// number of key pairs handed out from the pool
+	uint64_t depleted;	// number of requests that found the pool empty (computed by the caller)
+	uint32_t available;	// number of key pairs currently ready
+	uint32_t depth;		// capacity of the pool
+	uint8_t locked;		// the key pairs are locked in memory (mlock() succeeded)
+	double refill_rate;	// key pairs per second computed by the background threads since the pool creation
+} key_pool_stats;
+
+key_pool *key_pool_create(uint32_t depth, uint32_t threads);
+void key_pool_destroy(key_pool *pool);
+
+uint8_t key_pool_take(key_pool *pool, uint8_t sk[], proj pk);
+void key_pool_get_stats(key_pool *pool, key_pool_stats *stats);
+
+#endif /* Key pair pool */
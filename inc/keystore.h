@@ -0,0 +1,58 @@
+#ifndef _KEYSTORE_H_
+#define _KEYSTORE_H_
+
+#include <stddef.h>
+
+#include "edwards_curve.h"
+
+/*
+ * Binary keystore of public keys, mapped read-only with mmap(). Layout (host byte order):
+ *
+ *   keystore_header                    64 bytes
+ *   keystore_entry   index[count]      64 bytes each, sorted by name (binary search)
+ *   fp               keys[count]       64 bytes each: normalized Montgomery coefficient, little endian
+ *   proj             edwards[count]   128 bytes each: expanded Edwards curve (if KEYSTORE_EDWARDS)
+ *
+ * A record is only flagged KEYSTORE_VALIDATED if validate() accepted it when the keystore was written;
+ * derivations against such a record skip the validation.
+ */
+
+#define KEYSTORE_MAGIC "CSIDHKS\0"
+#define KEYSTORE_VERSION 1
+#define KEYSTORE_NAME 48	// including the terminating zero
+#define KEYSTORE_BITS (64 * NUMBER_OF_WORDS)
+
+#define KEYSTORE_VALIDATED 0x1	// the public key is a supersingular curve
+#define KEYSTORE_EDWARDS   0x2	// edwards[record] holds the expanded Edwards curve
+
+typedef struct {
+	char magic[8];
+	uint32_t version;
+	uint32_t bits;			// KEYSTORE_BITS of the field of the keys
+	uint64_t count;
+	uint64_t index_offset;
+	uint64_t keys_offset;
+	uint64_t edwards_offset;
+	uint8_t reserved[16];
+} keystore_header;
+
+typedef struct {
+	char name[KEYSTORE_NAME];
+	uint64_t record;		// position in keys[] and edwards[]
+	uint32_t flags;
+	uint32_t reserved;
+} keystore_entry;
+
+typedef struct keystore keystore;
+
+keystore *keystore_open(const char *path);
+void keystore_close(keystore *ks);
+size_t keystore_count(const keystore *ks);
+const keystore_entry *keystore_entry_at(const keystore *ks, size_t i);
+const keystore_entry *keystore_find(const keystore *ks, const char *name);
+const uint64_t *keystore_public_key(const keystore *ks, const keystore_entry *entry);
+uint8_t keystore_curve(proj A, const keystore *ks, const keystore_entry *entry);
+
+int keystore_write(const char *path, const char *names[], const fp keys[], size_t n, uint8_t validated);
+
+#endif /* Keystore */
@@ -0,0 +1,21 @@
+#ifndef _PARALLEL_H_
+#define _PARALLEL_H_
+
+#include <pthread.h>
+
+#include "edwards_curve.h"
+
+// Concurrent entry points built on top of validate() and action_evaluation(). Each class group action
+// runs on its own thread, so independent actions of the same protocol step overlap on a multicore host.
+// derive_many() uses the public key encoding of lib/public_key.c.
+
+uint8_t csidh_encapsulation(proj pk, proj ss, uint8_t sk[], const proj pk_peer);
+uint8_t csidh_speculative(proj out, const uint8_t sk[], const proj in);
+
+// validate() with the tree of cofactor_multiples() and the order checks split across threads
+uint8_t validate_parallel(const proj A, uint32_t threads);
+
+// Static-key derivations: out[i] = sk * pks[i] over normalized public keys, spread across threads
+size_t derive_many(const uint8_t sk[], const fp pks[], size_t n, fp out[], uint8_t valid[], uint32_t threads);
+
+#endif /* Concurrent CSIDH */
@@ -0,0 +1,14 @@
+#ifndef _PUBLIC_KEY_H_
+#define _PUBLIC_KEY_H_
+
+#include <stddef.h>
+
+#include "edwards_curve.h"
+
+// Conversions between the Edwards curves used internally and the normalized Montgomery coefficient
+// used for storing and exchanging public keys and shared secrets (see lib/public_key.c)
+void normalize_public_key(proj public_key, fp *out);
+void normalize_public_keys(proj public_keys[], fp out[], size_t n);
+void expand_public_key(proj expanded_public_key, const fp public_key);
+
+#endif /* Public key encoding */
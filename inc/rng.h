@@ -1,8 +1,17 @@
 #ifndef RNG_H
 #define RNG_H
 
+#include <stdint.h>
 #include <stdlib.h>
 
 void randombytes(void *x, size_t l);
 
+// Deterministic mode (reproducible benchmarks only): every thread's generator is derived from seed. The
+// calling thread gets the first stream; the other threads get the next ones in the order of their first
+// randombytes(), thus their outputs are only reproducible if that order is.
+void randombytes_seed(const uint8_t seed[32]);
+
+// Known-answer test of the ChaCha20 block function: 0 on success, -1 otherwise
+int randombytes_selftest(void);
+
 #endif
@@ -0,0 +1,46 @@
+#ifndef _TRACE_H_
+#define _TRACE_H_
+
+#include <stdint.h>
+#include <stdio.h>
+
+// Instrumentation of action_evaluation(), compiled in with -DACTION_TRACE (make ... TRACE=1) and out
+// otherwise. Each phase of each SIMBA round is recorded with its cycle count, and trace_dump() writes
+// the events in the Chrome trace format (chrome://tracing, Perfetto).
+
+enum {
+	TRACE_ACTION = 0,	// a whole action (its argument is the number of rounds)
+	TRACE_ROUND,		// a SIMBA round (its argument is the batch)
+	TRACE_ELLIGATOR,	// sampling of the torsion points
+	TRACE_COFACTOR,		// multiplication by 4 and by the l_i's out of the batch
+	TRACE_KERNEL,		// multiplication of the kernel generator by the remaining l_i's of the batch
+	TRACE_ISOGENY,		// yISOG, or yISOG_EVAL with KERNEL_BUDGET (its argument is the index of l_i)
+	TRACE_EVALUATION,	// yEVAL of the torsion points, and multiplication by l_i (with or without an isogeny)
+	TRACE_WASTED,		// a kernel computed in vain: its generator is at infinity (no isogeny for this l_i)
+	TRACE_PHASES
+};
+
+#ifdef ACTION_TRACE
+
+void trace_begin(uint8_t phase, uint32_t arg);
+void trace_end(uint8_t phase, uint32_t arg);
+void trace_end_as(uint8_t phase, uint8_t as);
+void trace_reset(void);
+int trace_dump(const char *path);
+void trace_summary(FILE *out);
+
+#define TRACE_BEGIN(phase, arg) trace_begin((phase), (arg))
+#define TRACE_END(phase) trace_end((phase), UINT32_MAX)
+#define TRACE_END_WITH(phase, arg) trace_end((phase), (arg))	// replaces the argument given at the beginning
+#define TRACE_END_AS(phase, as) trace_end_as((phase), (as))	// records the event as the phase as instead
+
+#else
+
+#define TRACE_BEGIN(phase, arg) ((void)0)
+#define TRACE_END(phase) ((void)0)
+#define TRACE_END_WITH(phase, arg) ((void)0)
+#define TRACE_END_AS(phase, as) ((void)0)
+
+#endif
+
+#endif /* Action tracing */
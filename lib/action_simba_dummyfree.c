@@ -1,5 +1,10 @@
 #include "edwards_curve.h"
 
+// The radical walks discard their steps beyond the exponent, which are dummy operations
+#if defined RADICAL
+#error "RADICAL=1 requires a TYPE with dummy isogenies (WITHDUMMY_1 or WITHDUMMY_2)"
+#endif
+
 void random_key(uint8_t key[])
 {
 	uint8_t i, tmp, r;
@@ -80,8 +85,9 @@ void action_evaluation(proj C, const uint8_t key[], const proj A)
 
 	// --------------------------------------------------------------------------------------------------------
 	// Copy of public and private data (the private key is modified each iteration)
-	uint8_t tmp_e[N];
-	memcpy(tmp_e, key, sizeof(uint8_t) * N);	// exponents
+	uint8_t tmp_e[KEY_STATE] __attribute__((aligned(32)));	// exponents (see lookup() and update())
+	memset(tmp_e, 0, sizeof(tmp_e));
+	memcpy(tmp_e, key, sizeof(uint8_t) * N);
 
 	proj current_A, current_T[2];
 	point_copy(current_A, A);			// initial Edwards curve constants a and (a -d)
@@ -91,7 +97,7 @@ void action_evaluation(proj C, const uint8_t key[], const proj A)
 	// Vairables required for running SIMBA
 	int8_t ec = 0;
 	uint16_t count = 0;
-	proj G[2], K[(LARGE_L >> 1) + 1];		// Current kernel
+	proj G[2], K[KERNEL_BLOCK];		// Current kernel
 	uint8_t finished[N];				// flag that determines if the maximum number of isogeny constructions has been reached
 	memset(finished, 0, sizeof(uint8_t) * N);
 
@@ -112,8 +118,12 @@ void action_evaluation(proj C, const uint8_t key[], const proj A)
 	uint64_t number_of_batches = NUMBER_OF_BATCHES;
 	uint32_t si;
 
+	TRACE_BEGIN(TRACE_ACTION, 0);
 	while (isog_counter < NUMBER_OF_ISOGENIES)
 	{
+		if ( (ACTION_ABORT != NULL) && (*ACTION_ABORT != 0) )
+			break;	// cancelled by another thread: the output is meaningless
+
 		m = (m + 1) % number_of_batches;
 		
 		if(count == MY*number_of_batches) {  	//merge the batches after my rounds
@@ -139,22 +149,25 @@ void action_evaluation(proj C, const uint8_t key[], const proj A)
 			}
 		}
 
+		TRACE_BEGIN(TRACE_ROUND, m);
 		// Before constructing isogenies, we must to search for suitable point
+		TRACE_BEGIN(TRACE_ELLIGATOR, m);
 		elligator(current_T[1], current_T[0], current_A);
+		TRACE_END(TRACE_ELLIGATOR);
 
+		TRACE_BEGIN(TRACE_COFACTOR, m);
 		// Next, it is required to multiply the point by 4 and each l_i that doesn't belong to the current batch
 		// T_{-}
-		yDBL(current_T[0], current_T[0], current_A); // mult. by [2]
-		yDBL(current_T[0], current_T[0], current_A); // mult. by [2]
+		yQUAD(current_T[0], current_T[0], current_A); // mult. by [4]
 		// T_{+}
-		yDBL(current_T[1], current_T[1], current_A); // mult. by [2]
-		yDBL(current_T[1], current_T[1], current_A); // mult. by [2]
+		yQUAD(current_T[1], current_T[1], current_A); // mult. by [4]
 		// Now, it is required to multiply by the complement of the batch
 		for(i = 0; i < size_of_each_complement_batch[m]; i++)
 		{
 			yMUL(current_T[0], current_T[0], current_A, complement_of_each_batch[m][i]);
 			yMUL(current_T[1], current_T[1], current_A, complement_of_each_batch[m][i]);
 		};
+		TRACE_END(TRACE_COFACTOR);
 
 		for(i = 0; i < size_of_each_batch[m]; i++)
 		{
@@ -169,13 +182,14 @@ void action_evaluation(proj C, const uint8_t key[], const proj A)
 				point_copy(G[0], current_T[0]);
 				point_copy(G[1], current_T[1]);
                 
-				ec = lookup(batches[m][i], tmp_e);	// To get current e_i in constant-time
+				ec = lookup(batches[m][i], (int8_t const *)tmp_e);	// To get current e_i in constant-time
 				fp_cswap(G[0][0], G[1][0], (ec & 1));		// constant-time swap: T_{+} or T_{-}, that is the question.
 				fp_cswap(G[0][1], G[1][1], (ec & 1));		// constant-time swap: T_{+} or T_{-}, that is the question.
 
 				fp_cswap(current_T[0][0], current_T[1][0], (ec & 1));		// constant-time swap: T_{+} or T_{-}, that is the question.
 				fp_cswap(current_T[0][1], current_T[1][1], (ec & 1));		// constant-time swap: T_{+} or T_{-}, that is the question.
                 
+				TRACE_BEGIN(TRACE_KERNEL, batches[m][i]);
 				for (j = (i + 1); j < size_of_each_batch[m]; j++)
 				{
 					if( finished[batches[m][j]] == 0 )
@@ -184,29 +198,45 @@ void action_evaluation(proj C, const uint8_t key[], const proj A)
 						yMUL(G[0], G[0], current_A, batches[m][j]);
 					};
 				};
+				// With a generator at infinity, the time spent on the kernel is lost
+				TRACE_END_AS(TRACE_KERNEL, ((isinfinity(G[0]) == 1) || (isinfinity(G[1]) == 1)) ? TRACE_WASTED : TRACE_KERNEL);
 
 				if ( (isinfinity(G[0]) != 1) && (isinfinity(G[1]) != 1) )	// Depending on randomness
 				{
 					bc = isequal(ec >> 1, 0) & 1;		// Bit that determine the current isogeny. This ask is done in constant-time
 
+					TRACE_BEGIN(TRACE_ISOGENY, batches[m][i]);
+#if defined KERNEL_BUDGET
+					// Streamed kernel: T[0] and T[1] are evaluated along the construction
+					yISOG_EVAL(K, current_A, current_T, (const proj *)current_T,
+					           (isequal(batches[m][i], last_isogeny[m]) == 0) ? 2 : 0, G[0], current_A, batches[m][i]);
+#else
 					yISOG(K, current_A, G[0], current_A, batches[m][i]);
+#endif
+					TRACE_END(TRACE_ISOGENY);
 					
+					TRACE_BEGIN(TRACE_EVALUATION, batches[m][i]);
 					if ( isequal(batches[m][i], last_isogeny[m]) == 0)	// constant-time ask: just for avoiding the last isogeny evaluation
 					{
+#if !defined KERNEL_BUDGET
 						yEVAL(current_T[0], current_T[0], K, batches[m][i]);	// evaluation of T[0]
 						yEVAL(current_T[1], current_T[1], K, batches[m][i]);	// evaluation of T[1]
+#endif
 
 						yMUL(current_T[1], current_T[1], current_A, batches[m][i]);	// [l]T[1]
 					};
+					TRACE_END(TRACE_EVALUATION);
 
-					tmp_e[batches[m][i]] = ((((ec >> 1) - (bc ^ 1)) ^ bc) << 1) ^ ((ec & 0x1) ^ bc);
+					update(batches[m][i], (int8_t *)tmp_e, ((((ec >> 1) - (bc ^ 1)) ^ bc) << 1) ^ ((ec & 0x1) ^ bc));
 					counter[batches[m][i]] -= 1;
 					isog_counter += 1;
 				}
 				else
 				{
 					// We must perform at most two scalar multiplications by l.
+					TRACE_BEGIN(TRACE_EVALUATION, batches[m][i]);
 					yMUL(current_T[1], current_T[1], current_A, batches[m][i]);
+					TRACE_END(TRACE_EVALUATION);
 				};
 
 				fp_cswap(current_T[0][0], current_T[1][0], (ec & 1));		// constant-time swap: T_{+} or T_{-}, that is the question.
@@ -222,7 +252,9 @@ void action_evaluation(proj C, const uint8_t key[], const proj A)
 			};
 		};
 		count += 1;
+		TRACE_END(TRACE_ROUND);
 	};
+	TRACE_END_WITH(TRACE_ACTION, count);
 	
 	// --------------------------------------------------------------------------------------------------------	
 	point_copy(C, current_A);
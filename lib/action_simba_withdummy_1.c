@@ -63,8 +63,9 @@ void action_evaluation(proj C, const uint8_t key[], const proj A)
 
 	// --------------------------------------------------------------------------------------------------------
 	// Copy of public and private data (the private key is modified each iteration)
-	uint8_t tmp_e[N];
-	memcpy(tmp_e, key, sizeof(uint8_t) * N);	// exponents
+	uint8_t tmp_e[KEY_STATE] __attribute__((aligned(32)));	// exponents (see lookup() and update())
+	memset(tmp_e, 0, sizeof(tmp_e));
+	memcpy(tmp_e, key, sizeof(uint8_t) * N);
 
 	proj current_A[2], current_Tp[2];
 	point_copy(current_A[0], A);			// initial Edwards curve constants a and (a -d)
@@ -74,7 +75,7 @@ void action_evaluation(proj C, const uint8_t key[], const proj A)
 	// Vairables required for running SIMBA
 	int8_t ec = 0, mask;
 	uint16_t count = 0;
-	proj G[2], K[(LARGE_L >> 1) + 1], Z;		// Current kernel
+	proj G[2], K[KERNEL_BLOCK], Z;		// Current kernel
 	uint8_t finished[N];				// flag that determines if the maximum number of isogeny constructions has been reached
 	memset(finished, 0, sizeof(uint8_t) * N);
 
@@ -95,8 +96,38 @@ void action_evaluation(proj C, const uint8_t key[], const proj A)
 	uint64_t number_of_batches = NUMBER_OF_BATCHES;
 	uint32_t si;
 
+	TRACE_BEGIN(TRACE_ACTION, 0);
+#if defined RADICAL
+	// The l_i's of degree 3 and 5 are walked by radical isogenies, and then they are finished for SIMBA:
+	// each one joins the complement of its batch
+	for(i = 0; i < N; i++)
+	{
+		if( RADICAL_DEGREE(L[i]) == 0 )
+			continue;
+
+		radical_isogenies(current_A[0], current_A[0], i, tmp_e[i], 1, B[i]);
+		for(m = 0; m < NUMBER_OF_BATCHES; m++)
+		{
+			for(j = 0; j < size_of_each_batch[m]; j++)
+			{
+				if( batches[m][j] == i )
+				{
+					complement_of_each_batch[m][size_of_each_complement_batch[m]] = i;
+					size_of_each_complement_batch[m] += 1;
+				};
+			};
+		};
+		finished[i] = 1;
+		counter[i] = 0;
+		isog_counter += B[i];
+	};
+	m = 0;
+#endif
 	while (isog_counter < NUMBER_OF_ISOGENIES)
 	{
+		if ( (ACTION_ABORT != NULL) && (*ACTION_ABORT != 0) )
+			break;	// cancelled by another thread: the output is meaningless
+
 		m = (m + 1) % number_of_batches;
 		
 		if(count == MY*number_of_batches) {  	//merge the batches after my rounds
@@ -122,15 +153,19 @@ void action_evaluation(proj C, const uint8_t key[], const proj A)
 			}
 		}
 
+		TRACE_BEGIN(TRACE_ROUND, m);
 		// Before constructing isogenies, we must to search for suitable point
+		TRACE_BEGIN(TRACE_ELLIGATOR, m);
 		elligator(current_Tp[0], current_Tp[1], current_A[0]);
+		TRACE_END(TRACE_ELLIGATOR);
 
+		TRACE_BEGIN(TRACE_COFACTOR, m);
 		// Next, it is required to multiply the point by 4 and each l_i that doesn't belong to the current batch
-		yDBL(current_Tp[0], current_Tp[0], current_A[0]); // mult. by [2]
-		yDBL(current_Tp[0], current_Tp[0], current_A[0]); // mult. by [2]
+		yQUAD(current_Tp[0], current_Tp[0], current_A[0]); // mult. by [4]
 		// Now, it is required to multiply by the complement of the batch
 		for(i = 0; i < size_of_each_complement_batch[m]; i++)
 			yMUL(current_Tp[0], current_Tp[0], current_A[0], complement_of_each_batch[m][i]);
+		TRACE_END(TRACE_COFACTOR);
 
 		for(i = 0; i < size_of_each_batch[m]; i++)
 		{
@@ -143,6 +178,7 @@ void action_evaluation(proj C, const uint8_t key[], const proj A)
 			{
 				// Now, a degree-(l_{batches[m][i]}) will be constructed
 				point_copy(G[0], current_Tp[0]);
+				TRACE_BEGIN(TRACE_KERNEL, batches[m][i]);
 				for (j = (i + 1); j < size_of_each_batch[m]; j++)
 				{
 					if( finished[batches[m][j]] == 0 )
@@ -151,39 +187,53 @@ void action_evaluation(proj C, const uint8_t key[], const proj A)
 						yMUL(G[0], G[0], current_A[0], batches[m][j]);
 					};
 				};
+				// With a generator at infinity, the time spent on the kernel is lost (nothing else is done)
+				TRACE_END_AS(TRACE_KERNEL, (isinfinity(G[0]) == 1) ? TRACE_WASTED : TRACE_KERNEL);
 
 				if ( isinfinity(G[0]) != 1 )
 				{
 					point_copy(G[1], current_Tp[0]);
 
-					ec = lookup(batches[m][i], tmp_e);	// To get current e_i in constant-time
+					ec = lookup(batches[m][i], (int8_t const *)tmp_e);	// To get current e_i in constant-time
 					bc = isequal(ec, 0) & 1;		// Bit that determines if a dummy operation will be perfomed
 
 					fp_cswap(G[0][0], G[1][0], bc);		// constant-time swap: dummy or not dummy, that is the question.
 					fp_cswap(G[0][1], G[1][1], bc);		// constant-time swap: dummy or not dummy, that is the question.
 
+					TRACE_BEGIN(TRACE_ISOGENY, batches[m][i]);
+#if defined KERNEL_BUDGET
+					// Streamed kernel: T[0] is evaluated along the construction
+					yISOG_EVAL(K, current_A[1], &current_Tp[1], (const proj *)&current_Tp[0],
+					           (isequal(batches[m][i], last_isogeny[m]) == 0) ? 1 : 0, G[0], current_A[0], batches[m][i]);
+#else
 					yISOG(K, current_A[1], G[0], current_A[0], batches[m][i]);
+#endif
+					TRACE_END(TRACE_ISOGENY);
 					
+					TRACE_BEGIN(TRACE_EVALUATION, batches[m][i]);
 					if ( isequal(batches[m][i], last_isogeny[m]) == 0)	// constant-time ask: just for avoiding the last isogeny evaluation
 					{
 						mask = isequal(L[batches[m][i]], 3);	// Just for catching the case l = 3. This ask is done in constant-time
 						si = (L[batches[m][i]] >> 1);		// (l - 1) / 2
 
+#if !defined KERNEL_BUDGET
 						yEVAL(current_Tp[1], current_Tp[0], K, batches[m][i]);
+#endif
 
-						yADD(Z, K[(si + mask) - 1], G[0], K[(si + mask) - 2]);	// [(l + 1)/2]G[0]
-						fp_cswap(Z[0], K[si][0], mask ^ 1);			// constant-time swap: catching degree-3 isogeny case
-						fp_cswap(Z[1], K[si][1], mask ^ 1);			// constant-time swap: catching degree-3 isogeny case
-						yADD(current_Tp[0], K[si], K[si - 1], G[0]);		// [l]G[0]
+						yADD(Z, K[KERNEL_INDEX((si + mask) - 1)], G[0], K[KERNEL_INDEX((si + mask) - 2)]);	// [(l + 1)/2]G[0]
+						fp_cswap(Z[0], K[KERNEL_INDEX(si)][0], mask ^ 1);	// constant-time swap: catching degree-3 isogeny case
+						fp_cswap(Z[1], K[KERNEL_INDEX(si)][1], mask ^ 1);	// constant-time swap: catching degree-3 isogeny case
+						yADD(current_Tp[0], K[KERNEL_INDEX(si)], K[KERNEL_INDEX(si - 1)], G[0]);	// [l]G[0]
 
 						fp_cswap(current_Tp[0][0], current_Tp[1][0], bc ^ 1);	// constant-time swap: dummy or not dummy, that is the question.
 						fp_cswap(current_Tp[0][1], current_Tp[1][1], bc ^ 1);	// constant-time swap: dummy or not dummy, that is the question.
 					};
+					TRACE_END(TRACE_EVALUATION);
 
 					fp_cswap(current_A[0][0], current_A[1][0], bc ^ 1);	// constant-time swap: dummy or not dummy, that is the question.
 					fp_cswap(current_A[0][1], current_A[1][1], bc ^ 1);	// constant-time swap: dummy or not dummy, that is the question.
 
-					tmp_e[batches[m][i]] = ec - (bc ^ 1);
+					update(batches[m][i], (int8_t *)tmp_e, ec - (bc ^ 1));
 					counter[batches[m][i]] -= 1;
 					isog_counter += 1;
 				}
@@ -198,7 +248,9 @@ void action_evaluation(proj C, const uint8_t key[], const proj A)
 			};
 		};
 		count += 1;
+		TRACE_END(TRACE_ROUND);
 	};
+	TRACE_END_WITH(TRACE_ACTION, count);
 	
 	// --------------------------------------------------------------------------------------------------------	
 	point_copy(C, current_A[0]);
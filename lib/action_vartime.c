@@ -0,0 +1,145 @@
+#include "edwards_curve.h"
+
+// VARIABLE-TIME ACTION: its running time and memory accesses depend on the exponents, thus it is only
+// meant for public exponent vectors (test vectors, benchmarks, public steps of a protocol). The programs
+// handling secret keys (csidh_util, csidhd and keystore_util) refuse to be built with it.
+
+void random_key(uint8_t key[])
+{
+	uint8_t i, tmp, r;
+	int8_t exp, sgn;
+	for(i = 0; i < N; i++)
+	{
+		// The keys of DUMMYFREE: e_i in |[-B, B]| and of the same parity than B
+		r = B[i] & 0x1;
+
+		randombytes(&tmp, 1);
+		while ( issmaller((int32_t)B[i], (int32_t)tmp) == -1 )
+			randombytes(&tmp, 1);
+
+		exp = (int8_t)tmp;
+		exp = ( (exp << 1) - (B[i] + r) ) >> 1;
+		exp = (exp << 1) + r;
+		sgn = exp >> 7;	// sign of exp
+
+		// Next, to write  key[i] = e || ((1 + sgn)/2)
+		cmov(&exp, -exp, sgn == -1);
+		key[i] = (exp << 1) ^ (1 & (1 + sgn));
+	};
+};
+
+void printf_key(uint8_t key[], char *c)
+{
+	int i;
+	printf("%s := ", c);
+	printf("{\t  %3d", (int)( (2*(key[0] & 0x1) - 1) * (key[0] >> 1) ));
+
+	for(i = 1; i < N; i++)
+	{
+		printf(", %3d", (int)( (2*(key[i] & 0x1) - 1) * (key[i] >> 1) ) );
+		if( (i % 18) == 17 )
+			printf("\n\t\t");
+	};
+
+	printf("};\n");
+};
+
+/* ----------------------------------------------------------------------------------------------- *
+   action_evaluation()
+   inputs: a the exponent vector (public), the Edwards curve constants A[0]:=a, and A[1]:=(a - d);
+   output: the isogenous Edwards curve constants C[0]:=a' and C[1]:=(a' - d') determined by the action
+           evaluated at the exponent vector and the curve A
+
+    NOTE: each round is a pass of positive steps with T_{+} and a pass of negative steps with T_{-},
+          each one over the l_i's whose exponents still have that sign: the point is multiplied by
+          4 and by the other l_i's, and then each l_i of the pass makes an isogeny from the point
+          multiplied by the l_i's of the pass not walked yet (when it is not the infinity point).
+          There are neither dummy isogenies nor batches, and a pass without l_i's is skipped.
+ * ----------------------------------------------------------------------------------------------- */
+void action_evaluation(proj C, const uint8_t key[], const proj A)
+{
+	int8_t e[N];			// remaining steps of each l_i (its sign is the direction)
+	uint8_t pass[N], size, i, j, k, s;
+	uint16_t count = 0;
+	proj current_A, T[2], G, K[KERNEL_BLOCK];
+
+	for(i = 0; i < N; i++)
+		e[i] = (int8_t)(key[i] >> 1) * ((key[i] & 0x1) ? 1 : -1);
+
+	point_copy(current_A, A);
+
+	TRACE_BEGIN(TRACE_ACTION, 0);
+	while (1)
+	{
+		if ( (ACTION_ABORT != NULL) && (*ACTION_ABORT != 0) )
+			break;	// cancelled by another thread: the output is meaningless
+
+		uint8_t remaining = 0;
+		for(s = 0; s < 2; s++)
+		{
+			// The pass of sign s: T_{+} for positive exponents (s = 0), T_{-} for negative ones (s = 1)
+			size = 0;
+			for(i = 0; i < N; i++)
+			{
+				if ( ((s == 0) && (e[i] > 0)) || ((s == 1) && (e[i] < 0)) )
+					pass[size++] = i;
+			};
+			if (size == 0)
+				continue;
+			remaining = 1;
+
+			TRACE_BEGIN(TRACE_ROUND, s);
+			TRACE_BEGIN(TRACE_ELLIGATOR, s);
+			elligator(T[0], T[1], current_A);
+			TRACE_END(TRACE_ELLIGATOR);
+
+			TRACE_BEGIN(TRACE_COFACTOR, s);
+			yQUAD(T[s], T[s], current_A);	// mult. by [4]
+			for(i = 0, k = 0; i < N; i++)
+			{
+				if ( (k < size) && (pass[k] == i) )
+					k += 1;
+				else
+					yMUL(T[s], T[s], current_A, i);
+			};
+			TRACE_END(TRACE_COFACTOR);
+
+			for(k = 0; k < size; k++)
+			{
+				i = pass[k];
+				TRACE_BEGIN(TRACE_KERNEL, i);
+				point_copy(G, T[s]);
+				for(j = k + 1; j < size; j++)
+					yMUL(G, G, current_A, pass[j]);
+				TRACE_END(TRACE_KERNEL);
+
+				if (isinfinity(G) == 1)
+					continue;	// T has no point of order l_i: this l_i waits for the next round
+
+				TRACE_BEGIN(TRACE_ISOGENY, i);
+#if defined KERNEL_BUDGET
+				yISOG_EVAL(K, current_A, &T[s], (const proj *)&T[s], (k + 1 < size) ? 1 : 0, G, current_A, i);
+#else
+				yISOG(K, current_A, G, current_A, i);
+#endif
+				TRACE_END(TRACE_ISOGENY);
+
+				TRACE_BEGIN(TRACE_EVALUATION, i);
+#if !defined KERNEL_BUDGET
+				if (k + 1 < size)
+					yEVAL(T[s], T[s], K, i);
+#endif
+				TRACE_END(TRACE_EVALUATION);
+
+				e[i] += (s == 0) ? -1 : 1;
+			};
+			count += 1;
+			TRACE_END(TRACE_ROUND);
+		};
+		if (remaining == 0)
+			break;
+	};
+	TRACE_END_WITH(TRACE_ACTION, count);
+
+	point_copy(C, current_A);
+};
@@ -0,0 +1,237 @@
+#include <errno.h>
+#include <pthread.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include "async.h"
+
+struct csidh_async {
+	pthread_mutex_t lock;
+	pthread_cond_t ready;
+	csidh_request *queue_head, *queue_tail;		// submitted, not started yet
+	csidh_request *done_head, *done_tail;		// computed, not polled yet
+	size_t queued, running;
+	int stop;
+	int fd;
+
+	key_pool *pool;
+	pthread_t *threads;
+	uint32_t number_of_threads;
+};
+
+static void compute(csidh_async *ctx, csidh_request *request)
+{
+	switch (request->op)
+	{
+		case CSIDH_ASYNC_ACTION:
+			action_evaluation(request->out, request->sk, request->in);
+			request->valid = 1;
+			break;
+		case CSIDH_ASYNC_DERIVE:
+			request->valid = validate(request->in);
+			if (request->valid)
+				action_evaluation(request->out, request->sk, request->in);
+			else
+			{
+				explicit_bzero(request->sk, sizeof(uint8_t) * N);
+				explicit_bzero(request->out, sizeof(proj));
+			};
+			break;
+		case CSIDH_ASYNC_KEYGEN:
+			if (ctx->pool != NULL)
+				key_pool_take(ctx->pool, request->sk, request->out);
+			else
+			{
+				random_key(request->sk);
+				action_evaluation(request->out, request->sk, E);
+			};
+			request->valid = 1;
+			break;
+		default:
+			request->valid = 0;
+	};
+};
+
+/* Each worker takes one request at a time and publishes it as soon as it is computed: a short queue is
+ * spread over all the workers, and no completion waits for other requests. */
+static void *async_worker(void *arg)
+{
+	csidh_async *ctx = (csidh_async *)arg;
+	csidh_request *request;
+	uint64_t one = 1;
+
+	while (1)
+	{
+		pthread_mutex_lock(&ctx->lock);
+		while ((ctx->queue_head == NULL) && !ctx->stop)
+			pthread_cond_wait(&ctx->ready, &ctx->lock);
+		if (ctx->queue_head == NULL)
+		{
+			pthread_mutex_unlock(&ctx->lock);
+			return NULL;
+		};
+		request = ctx->queue_head;
+		ctx->queue_head = request->next;
+		if (ctx->queue_head == NULL)
+			ctx->queue_tail = NULL;
+		ctx->queued -= 1;
+		ctx->running += 1;
+		pthread_mutex_unlock(&ctx->lock);
+
+		compute(ctx, request);
+
+		pthread_mutex_lock(&ctx->lock);
+		request->next = NULL;
+		if (ctx->done_tail != NULL)
+			ctx->done_tail->next = request;
+		else
+			ctx->done_head = request;
+		ctx->done_tail = request;
+		ctx->running -= 1;
+		pthread_mutex_unlock(&ctx->lock);
+		while ((write(ctx->fd, &one, sizeof(one)) < 0) && (errno == EINTR));
+	};
+};
+
+/* ----------------------------------------------------------------------------------------------- *
+   csidh_async_create()
+   inputs: the number of worker threads, and an optional pool of key pairs for CSIDH_ASYNC_KEYGEN;
+   output: a completion queue ready for csidh_submit() (NULL if it cannot be created).
+ * ----------------------------------------------------------------------------------------------- */
+csidh_async *csidh_async_create(uint32_t threads, key_pool *pool)
+{
+	uint32_t i;
+	csidh_async *ctx;
+
+	if (threads == 0)
+		return NULL;
+
+	ctx = calloc(1, sizeof(csidh_async));
+	if (ctx == NULL)
+		return NULL;
+	ctx->threads = calloc(threads, sizeof(pthread_t));
+	ctx->fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if ((ctx->threads == NULL) || (ctx->fd < 0))
+	{
+		if (ctx->fd >= 0)
+			close(ctx->fd);
+		free(ctx->threads);
+		free(ctx);
+		return NULL;
+	};
+	pthread_mutex_init(&ctx->lock, NULL);
+	pthread_cond_init(&ctx->ready, NULL);
+	ctx->pool = pool;
+
+	for (i = 0; i < threads; i++)
+	{
+		if (pthread_create(&ctx->threads[i], NULL, async_worker, ctx) != 0)
+			break;
+	};
+	ctx->number_of_threads = i;
+	if (i == 0)
+	{
+		csidh_async_destroy(ctx);
+		return NULL;
+	};
+	return ctx;
+};
+
+/* ----------------------------------------------------------------------------------------------- *
+   csidh_async_destroy()
+   input: a completion queue created by csidh_async_create();
+   Note: the requests already submitted are computed before the workers stop, and the ones that were
+         not polled are wiped (their memory belongs to the caller and is not freed).
+ * ----------------------------------------------------------------------------------------------- */
+void csidh_async_destroy(csidh_async *ctx)
+{
+	uint32_t i;
+	csidh_request *request;
+
+	if (ctx == NULL)
+		return;
+
+	pthread_mutex_lock(&ctx->lock);
+	ctx->stop = 1;
+	pthread_cond_broadcast(&ctx->ready);
+	pthread_mutex_unlock(&ctx->lock);
+	for (i = 0; i < ctx->number_of_threads; i++)
+		pthread_join(ctx->threads[i], NULL);
+
+	for (request = ctx->done_head; request != NULL; request = request->next)
+	{
+		explicit_bzero(request->sk, sizeof(uint8_t) * N);
+		explicit_bzero(request->out, sizeof(proj));
+	};
+	pthread_mutex_destroy(&ctx->lock);
+	pthread_cond_destroy(&ctx->ready);
+	close(ctx->fd);
+	free(ctx->threads);
+	free(ctx);
+};
+
+int csidh_async_fd(const csidh_async *ctx)
+{
+	return ctx->fd;
+};
+
+/* ----------------------------------------------------------------------------------------------- *
+   csidh_submit()
+   inputs: a completion queue, and a request filled according to its op;
+   Note: it never blocks on a class group action. The request is queued for the workers, and returned
+         later by csidh_poll().
+ * ----------------------------------------------------------------------------------------------- */
+void csidh_submit(csidh_async *ctx, csidh_request *request)
+{
+	request->next = NULL;
+	pthread_mutex_lock(&ctx->lock);
+	if (ctx->queue_tail != NULL)
+		ctx->queue_tail->next = request;
+	else
+		ctx->queue_head = request;
+	ctx->queue_tail = request;
+	ctx->queued += 1;
+	pthread_cond_signal(&ctx->ready);
+	pthread_mutex_unlock(&ctx->lock);
+};
+
+/* ----------------------------------------------------------------------------------------------- *
+   csidh_poll()
+   inputs: a completion queue, and room for at most max requests;
+   output: the number of completed requests stored in completions[] (in completion order).
+
+    NOTE: it never blocks. The eventfd is drained, and re-armed if more than max requests were
+          completed, so a level-triggered event loop keeps calling csidh_poll() until none is left.
+ * ----------------------------------------------------------------------------------------------- */
+size_t csidh_poll(csidh_async *ctx, csidh_request *completions[], size_t max)
+{
+	uint64_t counter = 1;
+	size_t n = 0;
+
+	if (read(ctx->fd, &counter, sizeof(counter)) < 0)
+		counter = 0;
+
+	pthread_mutex_lock(&ctx->lock);
+	while ((n < max) && (ctx->done_head != NULL))
+	{
+		completions[n++] = ctx->done_head;
+		ctx->done_head = ctx->done_head->next;
+	};
+	if (ctx->done_head == NULL)
+		ctx->done_tail = NULL;
+	else
+	{
+		counter = 1;
+		while ((write(ctx->fd, &counter, sizeof(counter)) < 0) && (errno == EINTR));
+	};
+	pthread_mutex_unlock(&ctx->lock);
+	return n;
+};
+
+void csidh_async_counts(csidh_async *ctx, size_t *queued, size_t *running)
+{
+	pthread_mutex_lock(&ctx->lock);
+	*queued = ctx->queued;
+	*running = ctx->running;
+	pthread_mutex_unlock(&ctx->lock);
+};
@@ -0,0 +1,348 @@
+#define _GNU_SOURCE
+#include <cpuid.h>
+#include <linux/perf_event.h>
+#include <math.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "bench.h"
+
+int bench_samples_init(bench_samples *s, const char *name, size_t capacity)
+{
+	s->name = name;
+	s->count = 0;
+	s->capacity = capacity;
+	s->values = malloc(((capacity > 0) ? capacity : 1) * sizeof(uint64_t));
+	return (s->values != NULL) ? 0 : -1;
+};
+
+void bench_samples_add(bench_samples *s, uint64_t value)
+{
+	if (s->count < s->capacity)
+		s->values[s->count++] = value;
+};
+
+void bench_samples_free(bench_samples *s)
+{
+	free(s->values);
+	s->values = NULL;
+	s->count = s->capacity = 0;
+};
+
+static int compare_u64(const void *a, const void *b)
+{
+	uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+	return (x > y) - (x < y);
+};
+
+// Nearest-rank percentile of sorted values
+static uint64_t percentile(const uint64_t sorted[], size_t n, unsigned q)
+{
+	size_t rank = (q * n + 99) / 100;
+	return sorted[(rank > 0) ? rank - 1 : 0];
+};
+
+/* ----------------------------------------------------------------------------------------------- *
+   bench_summarize()
+   input: the samples of one measurement;
+   output: their mean, (sample) standard deviation, extrema, median and 90th/99th percentiles.
+ * ----------------------------------------------------------------------------------------------- */
+void bench_summarize(const bench_samples *s, bench_summary *summary)
+{
+	uint64_t *sorted;
+	double variance = 0;
+	size_t i;
+
+	memset(summary, 0, sizeof(bench_summary));
+	summary->count = s->count;
+	if (s->count == 0)
+		return;
+
+	sorted = malloc(s->count * sizeof(uint64_t));
+	if (sorted == NULL)
+		exit(1);
+	memcpy(sorted, s->values, s->count * sizeof(uint64_t));
+	qsort(sorted, s->count, sizeof(uint64_t), compare_u64);
+
+	for (i = 0; i < s->count; i++)
+		summary->mean += (double)sorted[i];
+	summary->mean /= (double)s->count;
+	for (i = 0; i < s->count; i++)
+		variance += ((double)sorted[i] - summary->mean) * ((double)sorted[i] - summary->mean);
+	summary->stddev = (s->count > 1) ? sqrt(variance / (double)(s->count - 1)) : 0;
+
+	summary->min = sorted[0];
+	summary->max = sorted[s->count - 1];
+	summary->median = (s->count % 2) ? sorted[s->count / 2] : (sorted[s->count / 2 - 1] + sorted[s->count / 2]) / 2;
+	summary->p90 = percentile(sorted, s->count, 90);
+	summary->p99 = percentile(sorted, s->count, 99);
+	free(sorted);
+};
+
+// Pins the calling thread to a CPU (no frequency migrations between cores); returns 0 on success
+int bench_pin(int cpu)
+{
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(cpu, &set);
+	return sched_setaffinity(0, sizeof(set), &set);
+};
+
+void bench_environment_init(bench_environment *env, const char *program, int cpu, size_t iterations, size_t warmup)
+{
+	unsigned int eax, ebx, ecx, edx;
+	char path[96];
+	FILE *f;
+
+	env->program = program;
+	env->cpu = cpu;
+	env->iterations = iterations;
+	env->warmup = warmup;
+	env->unit = "cycles";
+	env->invariant_tsc = (__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) && (edx & (1u << 8))) ? 1 : 0;
+
+	strcpy(env->governor, "unknown");
+	snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cpufreq/scaling_governor", (cpu >= 0) ? cpu : 0);
+	if ((f = fopen(path, "r")) != NULL)
+	{
+		if (fscanf(f, "%31s", env->governor) != 1)
+			strcpy(env->governor, "unknown");
+		fclose(f);
+	};
+};
+
+int bench_parse_format(const char *str, bench_format *format)
+{
+	if (strcmp(str, "text") == 0)
+		*format = BENCH_TEXT;
+	else if (strcmp(str, "json") == 0)
+		*format = BENCH_JSON;
+	else if (strcmp(str, "csv") == 0)
+		*format = BENCH_CSV;
+	else
+		return -1;
+	return 0;
+};
+
+void bench_report_begin(FILE *out, bench_format format, const bench_environment *env)
+{
+	char unit[32];
+
+	switch (format)
+	{
+		case BENCH_JSON:
+			fprintf(out, "{\"program\": \"%s\", \"cpu\": %d, \"invariant_tsc\": %s, \"governor\": \"%s\", "
+			             "\"iterations\": %zu, \"warmup\": %zu, \"unit\": \"%s\", \"results\": [\n",
+			        env->program, env->cpu, env->invariant_tsc ? "true" : "false", env->governor,
+			        env->iterations, env->warmup, env->unit);
+			break;
+		case BENCH_CSV:
+			fprintf(out, "name,count,mean,stddev,min,median,p90,p99,max\n");
+			break;
+		default:
+			fprintf(out, "%s: %zu iterations (%zu warm-up), cpu %d, governor %s%s\n", env->program,
+			        env->iterations, env->warmup, env->cpu, env->governor,
+			        env->invariant_tsc ? "" : " (WARNING: the time-stamp counter is not invariant)");
+			snprintf(unit, sizeof(unit), "(%s)", env->unit);
+			fprintf(out, "%-24s %14s %12s %14s %14s %14s %14s %14s\n", unit, "mean", "stddev", "min",
+			        "median", "p90", "p99", "max");
+	};
+};
+
+void bench_report(FILE *out, bench_format format, const char *name, const bench_summary *summary, int first)
+{
+	switch (format)
+	{
+		case BENCH_JSON:
+			fprintf(out, "%s  {\"name\": \"%s\", \"count\": %zu, \"mean\": %.1f, \"stddev\": %.1f, \"min\": %lu, "
+			             "\"median\": %lu, \"p90\": %lu, \"p99\": %lu, \"max\": %lu}",
+			        first ? "" : ",\n", name, summary->count, summary->mean, summary->stddev, summary->min,
+			        summary->median, summary->p90, summary->p99, summary->max);
+			break;
+		case BENCH_CSV:
+			fprintf(out, "%s,%zu,%.1f,%.1f,%lu,%lu,%lu,%lu,%lu\n", name, summary->count, summary->mean,
+			        summary->stddev, summary->min, summary->median, summary->p90, summary->p99, summary->max);
+			break;
+		default:
+			fprintf(out, "%-24s %14.0f %12.0f %14lu %14lu %14lu %14lu %14lu\n", name, summary->mean,
+			        summary->stddev, summary->min, summary->median, summary->p90, summary->p99, summary->max);
+	};
+};
+
+void bench_report_end(FILE *out, bench_format format)
+{
+	if (format == BENCH_JSON)
+		fprintf(out, "\n]}\n");
+};
+
+const char *BENCH_COUNTER_NAMES[BENCH_COUNTERS] = { "cycles", "instructions", "branch_misses", "l1d_misses" };
+
+static int perf_open(uint32_t type, uint64_t config, int leader)
+{
+	struct perf_event_attr attr;
+
+	memset(&attr, 0, sizeof(attr));
+	attr.size = sizeof(attr);
+	attr.type = type;
+	attr.config = config;
+	attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+	attr.exclude_kernel = 1;	// allowed with perf_event_paranoid <= 2
+	attr.exclude_hv = 1;
+	return (int)syscall(SYS_perf_event_open, &attr, 0, -1, leader, 0);
+};
+
+/* ----------------------------------------------------------------------------------------------- *
+   bench_counters_open()
+   output: the number of counters that could be opened (0 if perf_event_open() is not permitted, or
+           if the CPU exposes no performance counters, as in many virtual machines).
+   The first counter opened leads the group of the others, so that all of them count the same code.
+ * ----------------------------------------------------------------------------------------------- */
+int bench_counters_open(bench_counters *c)
+{
+	const uint32_t type[BENCH_COUNTERS] = { PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE,
+	                                        PERF_TYPE_HW_CACHE };
+	const uint64_t config[BENCH_COUNTERS] = { PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+	                                          PERF_COUNT_HW_BRANCH_MISSES,
+	                                          PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+	                                          (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) };
+	int leader = -1, opened = 0;
+
+	memset(c, 0, sizeof(bench_counters));
+	for (int i = 0; i < BENCH_COUNTERS; i++)
+	{
+		c->fd[i] = perf_open(type[i], config[i], leader);
+		if ((c->fd[i] >= 0) && (leader < 0))
+			leader = c->fd[i];
+		opened += (c->fd[i] >= 0);
+	};
+	return opened;
+};
+
+// Value of a counter, and the times it was enabled and running (in nanoseconds)
+static void perf_read(int fd, uint64_t value[3])
+{
+	if ((fd < 0) || (read(fd, value, 3 * sizeof(uint64_t)) != 3 * sizeof(uint64_t)))
+		value[0] = value[1] = value[2] = 0;
+};
+
+void bench_counters_start(bench_counters *c)
+{
+	uint64_t value[3];
+	for (int i = 0; i < BENCH_COUNTERS; i++)
+	{
+		perf_read(c->fd[i], value);
+		c->start[i] = value[0];
+		c->enabled[i] = value[1];
+		c->running[i] = value[2];
+	};
+};
+
+/* ----------------------------------------------------------------------------------------------- *
+   bench_counters_stop()
+   Adds the counts since bench_counters_start() to the totals. If the group was not running all the
+   time it was enabled (multiplexed with other events), each count is extrapolated to the enabled
+   time, and the measurement is counted as multiplexed.
+ * ----------------------------------------------------------------------------------------------- */
+void bench_counters_stop(const bench_counters *c, bench_counts *counts)
+{
+	uint64_t value[3], enabled, running;
+	int multiplexed = 0;
+
+	for (int i = 0; i < BENCH_COUNTERS; i++)
+	{
+		if (c->fd[i] < 0)
+			continue;
+		perf_read(c->fd[i], value);
+		value[0] -= c->start[i];
+		enabled = value[1] - c->enabled[i];
+		running = value[2] - c->running[i];
+		if (running < enabled)
+		{
+			value[0] = (running > 0) ? (uint64_t)((double)value[0] * (double)enabled / (double)running) : 0;
+			multiplexed = 1;
+		};
+		counts->total[i] += value[0];
+	};
+	counts->measurements += 1;
+	counts->multiplexed += multiplexed;
+};
+
+void bench_counters_close(bench_counters *c)
+{
+	for (int i = 0; i < BENCH_COUNTERS; i++)
+		if (c->fd[i] >= 0)
+			close(c->fd[i]);
+};
+
+// Mean of each counter per measurement, and instructions per cycle (null/empty when unavailable). The
+// text report is a second table (first prints its header); the CSV one is its own table, to be written
+// to another file than the summaries; the JSON entries form the "counters" array that follows the
+// results (first closes the results), thus they must be reported after every bench_report().
+void bench_report_counters(FILE *out, bench_format format, const char *name, const bench_counters *c,
+                           const bench_counts *counts, int first)
+{
+	double mean[BENCH_COUNTERS];
+	double n = (counts->measurements > 0) ? (double)counts->measurements : 1;
+	int ipc = (c->fd[BENCH_CYCLES] >= 0) && (c->fd[BENCH_INSTRUCTIONS] >= 0) && (counts->total[BENCH_CYCLES] > 0);
+	int i;
+
+	for (i = 0; i < BENCH_COUNTERS; i++)
+		mean[i] = (double)counts->total[i] / n;
+	if (counts->multiplexed > 0)
+		fprintf(stderr, "%s: the counters were multiplexed during %lu of %lu measurements (scaled counts)\n", name,
+		        counts->multiplexed, counts->measurements);
+
+	switch (format)
+	{
+		case BENCH_JSON:
+			fprintf(out, "%s  {\"name\": \"%s\", \"measurements\": %lu, \"multiplexed\": %lu",
+			        first ? "\n], \"counters\": [\n" : ",\n", name, counts->measurements, counts->multiplexed);
+			for (i = 0; i < BENCH_COUNTERS; i++)
+			{
+				if (c->fd[i] >= 0)
+					fprintf(out, ", \"%s\": %.1f", BENCH_COUNTER_NAMES[i], mean[i]);
+				else
+					fprintf(out, ", \"%s\": null", BENCH_COUNTER_NAMES[i]);
+			};
+			if (ipc)
+				fprintf(out, ", \"ipc\": %.3f}", mean[BENCH_INSTRUCTIONS] / mean[BENCH_CYCLES]);
+			else
+				fprintf(out, ", \"ipc\": null}");
+			break;
+		case BENCH_CSV:
+			if (first)
+				fprintf(out, "name,measurements,multiplexed,cycles,instructions,branch_misses,l1d_misses,ipc\n");
+			fprintf(out, "%s,%lu,%lu", name, counts->measurements, counts->multiplexed);
+			for (i = 0; i < BENCH_COUNTERS; i++)
+			{
+				if (c->fd[i] >= 0)
+					fprintf(out, ",%.1f", mean[i]);
+				else
+					fprintf(out, ",");
+			};
+			if (ipc)
+				fprintf(out, ",%.3f\n", mean[BENCH_INSTRUCTIONS] / mean[BENCH_CYCLES]);
+			else
+				fprintf(out, ",\n");
+			break;
+		default:
+			if (first)
+				fprintf(out, "%-24s %14s %14s %14s %14s %6s\n", "(per action)", "cycles", "instructions",
+				        "branch_misses", "l1d_misses", "IPC");
+			fprintf(out, "%-24s", name);
+			for (i = 0; i < BENCH_COUNTERS; i++)
+			{
+				if (c->fd[i] >= 0)
+					fprintf(out, " %14.0f", mean[i]);
+				else
+					fprintf(out, " %14s", "n/a");
+			};
+			if (ipc)
+				fprintf(out, " %6.2f\n", mean[BENCH_INSTRUCTIONS] / mean[BENCH_CYCLES]);
+			else
+				fprintf(out, " %6s\n", "n/a");
+	};
+};
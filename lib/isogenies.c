@@ -85,6 +85,10 @@ void yISOG(proj Pk[], proj C, const proj P, const proj A, const uint8_t i)
 	FP_MUL_COMPUTED += 4;
 };// Cost ~ (3l + log(l) - 7)M + (l + 2log(l) + 3)S + (3l - 1)a
 
+// Kernel points requested ahead of their use by yEVAL(): they are read once, in order, and for the
+// largest l_i they no longer fit in the L1 cache (e.g. 37.5 KB for l = 587 with p512)
+#define KERNEL_PREFETCH_DISTANCE 4
+
 /* ----------------------------------------------------------------------------- *
    yEVAL()
    Inputs: the projective Edwards y-coordinate of y(Q)=YQ/ZQ, the y-coordinate 
@@ -92,6 +96,9 @@ void yISOG(proj Pk[], proj C, const proj P, const proj A, const uint8_t i)
            0 <= i < N;
    Output: the image of y(Q) under a degree-L[i] isogeny with kernel generated 
            by y(P).
+
+    NOTE: YP and ZP of each kernel point are adjacent (proj), so that the
+          kernel is read as a single sequential stream.
  * ----------------------------------------------------------------------------- */
 void yEVAL(proj R, const proj Q, const proj Pk[], const uint8_t i)
 {
@@ -111,6 +118,11 @@ void yEVAL(proj R, const proj Q, const proj Pk[], const uint8_t i)
 	uint64_t s = (L[i] >> 1);
 	for(j = 1; j < s; j++)
 	{
+		if ((j + KERNEL_PREFETCH_DISTANCE) < s)
+		{
+			for (size_t k = 0; k < sizeof(proj); k += 64)	// cache lines
+				_mm_prefetch((const char *)Pk[j + KERNEL_PREFETCH_DISTANCE] + k, _MM_HINT_T0);
+		};
 		// Evaluating Q
 		fp_mul(s_0, tmp_Q[0], Pk[j][1]);
 		fp_mul(s_1, tmp_Q[1], Pk[j][0]);
@@ -139,3 +151,166 @@ void yEVAL(proj R, const proj Q, const proj Pk[], const uint8_t i)
 	FP_MUL_COMPUTED += 4;
 };// Cost : 2(l - 1)M + 2S + (3 + l)a
 
+
+/* ----------------------------------------------------------------------------- *
+   kernel_block_evaluation()
+   Inputs: the points y(Q[k]) for 0 <= k < count, and the kernel points with
+           indexes first, ..., last - 1 of the ring buffer Pk;
+   Output: the products of yEVAL() for those kernel points, accumulated in R[k].
+ * ----------------------------------------------------------------------------- */
+static void kernel_block_evaluation(proj R[], const proj Q[], const uint8_t count, const proj Pk[],
+                                    uint64_t first, uint64_t last)
+{
+	uint64_t j;
+	uint8_t k;
+	fp tmp_0, tmp_1, s_0, s_1;
+
+	for (k = 0; k < count; k++)
+	{
+		for (j = first; j < last; j++)
+		{
+			// Evaluating Q
+			fp_mul(s_0, Q[k][0], Pk[KERNEL_INDEX(j)][1]);
+			fp_mul(s_1, Q[k][1], Pk[KERNEL_INDEX(j)][0]);
+			if (j == 0)
+			{
+				// Mapping R into the isomorphic Montgomery curve
+				fp_add(R[k][0], s_0, s_1);
+				fp_sub(R[k][1], s_0, s_1);
+				continue;
+			};
+			fp_add(tmp_0, s_0, s_1);
+			fp_sub(tmp_1, s_0, s_1);
+			fp_mul(R[k][0], R[k][0], tmp_0);
+			fp_mul(R[k][1], R[k][1], tmp_1);
+
+			FP_ADD_COMPUTED += 2;
+			FP_MUL_COMPUTED += 4;
+		};
+	};
+};
+
+/* ----------------------------------------------------------------------------- *
+   yISOG_EVAL()
+   Inputs: the projective Edwards y-coordinate of y(P)=YP/ZP, the Edwards curve
+           constant A[0]:=a and A[1]:=(a - d), count <= ISOG_EVAL_POINTS points
+           y(Q[k]), and integer number 0 <= i < N;
+   Output: the curve C of yISOG(), and the images R[k] of the y(Q[k]) of
+           yEVAL(). Pk is a ring buffer of KERNEL_BLOCK points: y([j + 1]P) is
+           written in Pk[KERNEL_INDEX(j)], and the last ones are kept.
+
+    NOTE: the kernel points are generated and evaluated by blocks of
+          KERNEL_BLOCK points. [j + 1]P only depends on [j]P and [j - 1]P, thus
+          no point is computed twice whatever the size of the block: the cost
+          is the one of yISOG() and count calls to yEVAL().
+ * ----------------------------------------------------------------------------- */
+void yISOG_EVAL(proj Pk[], proj C, proj R[], const proj Q[], const uint8_t count, const proj P, const proj A,
+                const uint8_t i)
+{
+	uint8_t k, mask;
+	int64_t bits_l;
+	uint64_t j, first,
+	         l = L[i],				// l_i
+	         s = l >> 1;				// s <- (l_i - 1) / 2
+
+	assert(count <= ISOG_EVAL_POINTS);
+	bits_l = 0;
+	while (l > 0)
+	{
+		l >>= 1;
+		bits_l += 1;
+	};	// number of bits of l
+	l = L[i];
+	// ---
+	fp By[2], Bz[2], tmp_0, tmp_1, tmp_d;
+	proj tmp_Q[ISOG_EVAL_POINTS];
+
+	for (k = 0; k < count; k++)
+		point_copy(tmp_Q[k], Q[k]);		// This is for allowing Q <- image of Q
+
+	copy(tmp_0, A[0], NUMBER_OF_WORDS);		// a
+	fp_sub(tmp_d, A[0], A[1]);			// d
+	copy(tmp_1, tmp_d, NUMBER_OF_WORDS);
+
+	copy(By[0], P[0], NUMBER_OF_WORDS); copy(By[1], P[0], NUMBER_OF_WORDS);
+	copy(Bz[0], P[1], NUMBER_OF_WORDS); copy(Bz[1], P[1], NUMBER_OF_WORDS);
+
+	point_copy(Pk[KERNEL_INDEX(0)], P);		// P
+	yDBL(Pk[KERNEL_INDEX(1)], P, A);		// [2]P
+
+	first = 0;					// first kernel point not evaluated yet
+	for(j = 2; j < s; j++)
+	{
+		// [j + 1]P overwrites [j + 1 - KERNEL_BLOCK]P: the block is evaluated before
+		if ((j - first) == KERNEL_BLOCK)
+		{
+			kernel_block_evaluation(R, (const proj *)tmp_Q, count, (const proj *)Pk, first, j);
+			first = j;
+		};
+		fp_mul(By[0], By[0], Pk[KERNEL_INDEX(j - 1)][0]);
+		fp_mul(Bz[0], Bz[0], Pk[KERNEL_INDEX(j - 1)][1]);
+		yADD(Pk[KERNEL_INDEX(j)], Pk[KERNEL_INDEX(j - 1)], P, Pk[KERNEL_INDEX(j - 2)]);	// [j + 1]P
+
+		FP_MUL_COMPUTED += 2;
+	};
+	kernel_block_evaluation(R, (const proj *)tmp_Q, count, (const proj *)Pk, first, s);
+
+	mask = isequal(l, 3) ^ 1;		// If l = 3 then we keep with the current values of By[0] and Bz[0]. This ask is done in constant-time
+	fp_mul(By[1], By[0], Pk[KERNEL_INDEX(s - 1)][0]);	// This an extra cost for a degree-3 construction
+	fp_mul(Bz[1], Bz[0], Pk[KERNEL_INDEX(s - 1)][1]);	// This an extra cost for a degree-3 construction
+	fp_cswap(By[0], By[1], mask);		// constant-time swap: dummy or not dummy, that is the question.
+	fp_cswap(Bz[0], Bz[1], mask);		// constant-time swap: dummy or not dummy, that is the question.
+
+	// left-to-right method for computing a^l and d^l
+	bits_l -= 1;
+	for(j = 1; j <= bits_l; j++)
+	{
+		fp_sqr(tmp_0, tmp_0);
+		fp_sqr(tmp_1, tmp_1);
+		if( ( (l >> (bits_l - j)) & 1 ) != 0)
+		{
+			fp_mul(tmp_0, tmp_0, A[0]);
+			fp_mul(tmp_1, tmp_1, tmp_d);
+
+			FP_MUL_COMPUTED += 2;
+		};
+
+		FP_SQR_COMPUTED += 2;
+	};
+
+	for(j = 0; j < 3; j++)
+	{
+		fp_sqr(By[0], By[0]);
+		fp_sqr(Bz[0], Bz[0]);
+
+		FP_SQR_COMPUTED += 2;
+	};
+
+	// The images of the points
+	for (k = 0; k < count; k++)
+	{
+		fp tmp_2, tmp_3;
+		fp_sqr(R[k][0], R[k][0]);
+		fp_sqr(R[k][1], R[k][1]);
+		// Mapping Q into the isomorphic Montgomery curve
+		fp_add(tmp_2, tmp_Q[k][1], tmp_Q[k][0]);
+		fp_sub(tmp_3, tmp_Q[k][1], tmp_Q[k][0]);
+		fp_mul(tmp_2, R[k][0], tmp_2);
+		fp_mul(tmp_3, R[k][1], tmp_3);
+		// Mapping R into the Edwards curve
+		fp_sub(R[k][0], tmp_2, tmp_3);
+		fp_add(R[k][1], tmp_2, tmp_3);
+
+		FP_ADD_COMPUTED += 6;
+		FP_SQR_COMPUTED += 2;
+		FP_MUL_COMPUTED += 4;
+	};
+
+	// The isogenous curve
+	fp_mul(C[0], tmp_0, Bz[0]);
+	fp_mul(C[1], tmp_1, By[0]);
+	fp_sub(C[1], C[0], C[1]);
+
+	FP_ADD_COMPUTED += 2;
+	FP_MUL_COMPUTED += 4;
+};// Cost : the one of yISOG() plus count times the one of yEVAL()
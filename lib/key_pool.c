@@ -0,0 +1,215 @@
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "key_pool.h"
+
+#define SLOT_EMPTY 0	// waiting for a background thread
+#define SLOT_BUSY  1	// being filled by a background thread, or being taken by a consumer
+#define SLOT_READY 2	// holds a key pair that has never been handed out
+
+typedef struct {
+	atomic_int state;
+	uint8_t sk[N];
+	proj pk;
+} __attribute__((aligned(64))) key_slot;
+
+struct key_pool {
+	key_slot *slots;
+	uint32_t depth;
+	size_t size;			// bytes of slots (whole pages)
+	uint8_t locked;			// the slots cannot be swapped out
+
+	pthread_t *threads;
+	uint32_t number_of_threads;
+	sem_t empty_slots;		// producers sleep here while the pool is full
+	atomic_int stop;
+
+	atomic_uint cursor;		// where the next consumer starts looking for a ready slot
+	atomic_uint_fast64_t generated, served, depleted;
+	atomic_uint available;
+	struct timespec created;
+};
+
+static void key_pair(uint8_t sk[], proj pk)
+{
+	random_key(sk);
+	action_evaluation(pk, sk, E);	// E is public and valid: no validation is required
+};
+
+static void *key_pool_worker(void *arg)
+{
+	key_pool *pool = (key_pool *)arg;
+	uint32_t i;
+	int expected;
+
+	while (1)
+	{
+		sem_wait(&pool->empty_slots);
+		if (atomic_load(&pool->stop))
+			break;
+
+		// At least one slot is empty: claim it
+		for (i = 0; ; i = (i + 1) % pool->depth)
+		{
+			expected = SLOT_EMPTY;
+			if (atomic_compare_exchange_strong(&pool->slots[i].state, &expected, SLOT_BUSY))
+				break;
+		};
+
+		key_pair(pool->slots[i].sk, pool->slots[i].pk);
+		// Counted before it is published: a consumer taking the slot decrements available afterwards,
+		// so that it never goes below zero
+		atomic_fetch_add(&pool->available, 1);
+		atomic_store_explicit(&pool->slots[i].state, SLOT_READY, memory_order_release);
+		atomic_fetch_add(&pool->generated, 1);
+	};
+	return NULL;
+};
+
+/* ----------------------------------------------------------------------------------------------- *
+   key_pool_create()
+   inputs: the number of key pairs to be kept ready, and the number of background threads;
+   output: a pool whose threads start filling it immediately (NULL if it cannot be created).
+   The slots take pages of their own, locked in memory unless RLIMIT_MEMLOCK forbids it (see the
+   locked field of key_pool_stats).
+ * ----------------------------------------------------------------------------------------------- */
+key_pool *key_pool_create(uint32_t depth, uint32_t threads)
+{
+	uint32_t i;
+	key_pool *pool;
+	long page = sysconf(_SC_PAGESIZE);
+
+	if ((depth == 0) || (threads == 0))
+		return NULL;
+	if (page <= 0)
+		page = 4096;
+
+	pool = calloc(1, sizeof(key_pool));
+	if (pool == NULL)
+		return NULL;
+	pool->size = ((sizeof(key_slot) * depth + (size_t)page - 1) / (size_t)page) * (size_t)page;
+	pool->slots = aligned_alloc((size_t)page, pool->size);
+	pool->threads = calloc(threads, sizeof(pthread_t));
+	if ((pool->slots == NULL) || (pool->threads == NULL) || (sem_init(&pool->empty_slots, 0, depth) != 0))
+	{
+		free(pool->slots);
+		free(pool->threads);
+		free(pool);
+		return NULL;
+	};
+
+	memset(pool->slots, 0, pool->size);
+	pool->locked = (mlock(pool->slots, pool->size) == 0);
+	for (i = 0; i < depth; i++)
+		atomic_init(&pool->slots[i].state, SLOT_EMPTY);
+	pool->depth = depth;
+	atomic_init(&pool->stop, 0);
+	atomic_init(&pool->cursor, 0);
+	atomic_init(&pool->generated, 0);
+	atomic_init(&pool->served, 0);
+	atomic_init(&pool->depleted, 0);
+	atomic_init(&pool->available, 0);
+	clock_gettime(CLOCK_MONOTONIC, &pool->created);
+
+	for (i = 0; i < threads; i++)
+	{
+		if (pthread_create(&pool->threads[i], NULL, key_pool_worker, pool) != 0)
+			break;
+	};
+	pool->number_of_threads = i;
+	if (i == 0)
+	{
+		key_pool_destroy(pool);
+		return NULL;
+	};
+	return pool;
+};
+
+/* ----------------------------------------------------------------------------------------------- *
+   key_pool_destroy()
+   input: a pool created by key_pool_create();
+   Note: the background threads are stopped, and every key pair left in the pool is wiped before its
+         pages are unlocked.
+ * ----------------------------------------------------------------------------------------------- */
+void key_pool_destroy(key_pool *pool)
+{
+	uint32_t i;
+
+	if (pool == NULL)
+		return;
+
+	atomic_store(&pool->stop, 1);
+	for (i = 0; i < pool->number_of_threads; i++)
+		sem_post(&pool->empty_slots);
+	for (i = 0; i < pool->number_of_threads; i++)
+		pthread_join(pool->threads[i], NULL);
+
+	explicit_bzero(pool->slots, pool->size);
+	if (pool->locked)
+		munlock(pool->slots, pool->size);
+	sem_destroy(&pool->empty_slots);
+	free(pool->slots);
+	free(pool->threads);
+	free(pool);
+};
+
+/* ----------------------------------------------------------------------------------------------- *
+   key_pool_take()
+   input: a pool created by key_pool_create();
+   output: a fresh secret key sk and its public curve pk = sk * E. It returns 1 if the key pair comes
+           from the pool, and 0 if the pool was depleted and the key pair was computed by the caller.
+
+    NOTE: consumers never lock nor wait for the background threads. A ready slot is claimed by a
+          compare-and-swap, copied, wiped, and given back to the producers through the semaphore.
+ * ----------------------------------------------------------------------------------------------- */
+uint8_t key_pool_take(key_pool *pool, uint8_t sk[], proj pk)
+{
+	uint32_t i, j, start;
+	int expected;
+
+	start = atomic_fetch_add(&pool->cursor, 1);
+	for (j = 0; j < pool->depth; j++)
+	{
+		i = (start + j) % pool->depth;
+		expected = SLOT_READY;
+		if (atomic_compare_exchange_strong_explicit(&pool->slots[i].state, &expected, SLOT_BUSY, memory_order_acquire, memory_order_relaxed))
+		{
+			memcpy(sk, pool->slots[i].sk, sizeof(uint8_t) * N);
+			point_copy(pk, pool->slots[i].pk);
+			explicit_bzero(pool->slots[i].sk, sizeof(uint8_t) * N);
+			explicit_bzero(pool->slots[i].pk, sizeof(proj));
+
+			atomic_fetch_sub(&pool->available, 1);
+			atomic_store_explicit(&pool->slots[i].state, SLOT_EMPTY, memory_order_release);
+			sem_post(&pool->empty_slots);
+			atomic_fetch_add(&pool->served, 1);
+			return 1;
+		};
+	};
+
+	// The pool is depleted
+	atomic_fetch_add(&pool->depleted, 1);
+	key_pair(sk, pk);
+	return 0;
+};
+
+void key_pool_get_stats(key_pool *pool, key_pool_stats *stats)
+{
+	struct timespec now;
+	double elapsed;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	elapsed = (double)(now.tv_sec - pool->created.tv_sec) + 1e-9 * (double)(now.tv_nsec - pool->created.tv_nsec);
+
+	stats->generated = atomic_load(&pool->generated);
+	stats->served = atomic_load(&pool->served);
+	stats->depleted = atomic_load(&pool->depleted);
+	stats->available = atomic_load(&pool->available);
+	stats->depth = pool->depth;
+	stats->locked = pool->locked;
+	stats->refill_rate = (elapsed > 0) ? (double)stats->generated / elapsed : 0;
+};
@@ -0,0 +1,235 @@
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "keystore.h"
+#include "public_key.h"
+
+struct keystore {
+	const uint8_t *map;
+	size_t size;
+	const keystore_header *header;
+	const keystore_entry *index;
+	const fp *keys;
+	const proj *edwards;
+};
+
+/* ----------------------------------------------------------------------------------------------- *
+   keystore_open()
+   input: the path of a keystore written by keystore_write();
+   output: the keystore mapped read-only, or NULL if the file is missing, truncated, was written
+           for another prime, or has an index entry pointing out of the records (or with an
+           unterminated name): the accessors below never check the entries again.
+ * ----------------------------------------------------------------------------------------------- */
+keystore *keystore_open(const char *path)
+{
+	struct stat st;
+	keystore *ks;
+	const keystore_header *header;
+	int fd;
+
+	if ((fd = open(path, O_RDONLY | O_CLOEXEC)) < 0)
+		return NULL;
+	if ((fstat(fd, &st) < 0) || ((size_t)st.st_size < sizeof(keystore_header)))
+	{
+		close(fd);
+		return NULL;
+	};
+
+	ks = calloc(1, sizeof(keystore));
+	if (ks == NULL)
+	{
+		close(fd);
+		return NULL;
+	};
+	ks->size = st.st_size;
+	ks->map = mmap(NULL, ks->size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (ks->map == MAP_FAILED)
+	{
+		free(ks);
+		return NULL;
+	};
+
+	header = (const keystore_header *)ks->map;
+	if ((memcmp(header->magic, KEYSTORE_MAGIC, sizeof(header->magic)) != 0) ||
+	    (header->version != KEYSTORE_VERSION) || (header->bits != KEYSTORE_BITS) ||
+	    (header->count > ks->size) || (header->index_offset > ks->size) ||
+	    (header->keys_offset > ks->size) || (header->edwards_offset > ks->size) ||
+	    ((header->index_offset | header->keys_offset | header->edwards_offset) % 64 != 0) ||
+	    (header->index_offset + header->count * sizeof(keystore_entry) > ks->size) ||
+	    (header->keys_offset + header->count * sizeof(fp) > ks->size) ||
+	    (header->edwards_offset + header->count * sizeof(proj) > ks->size))
+	{
+		munmap((void *)ks->map, ks->size);
+		free(ks);
+		return NULL;
+	};
+
+	ks->header = header;
+	ks->index = (const keystore_entry *)(ks->map + header->index_offset);
+	for (size_t i = 0; i < header->count; i++)
+	{
+		if ((ks->index[i].record >= header->count) || (ks->index[i].name[KEYSTORE_NAME - 1] != '\0'))
+		{
+			munmap((void *)ks->map, ks->size);
+			free(ks);
+			return NULL;
+		};
+	};
+	ks->keys = (const fp *)(ks->map + header->keys_offset);
+	ks->edwards = (const proj *)(ks->map + header->edwards_offset);
+	return ks;
+};
+
+void keystore_close(keystore *ks)
+{
+	if (ks == NULL)
+		return;
+	munmap((void *)ks->map, ks->size);
+	free(ks);
+};
+
+size_t keystore_count(const keystore *ks)
+{
+	return ks->header->count;
+};
+
+const keystore_entry *keystore_entry_at(const keystore *ks, size_t i)
+{
+	return (i < ks->header->count) ? &ks->index[i] : NULL;
+};
+
+/* ----------------------------------------------------------------------------------------------- *
+   keystore_find()
+   inputs: a keystore, and the name of a key;
+   output: its index entry (binary search over the sorted index), or NULL if there is none.
+ * ----------------------------------------------------------------------------------------------- */
+const keystore_entry *keystore_find(const keystore *ks, const char *name)
+{
+	size_t lower = 0, upper = ks->header->count, middle;
+	int c;
+
+	while (lower < upper)
+	{
+		middle = lower + (upper - lower) / 2;
+		c = strncmp(name, ks->index[middle].name, KEYSTORE_NAME);
+		if (c == 0)
+			return &ks->index[middle];
+		if (c < 0)
+			upper = middle;
+		else
+			lower = middle + 1;
+	};
+	return NULL;
+};
+
+// The normalized public key of an entry (a pointer into the mapping: no copy)
+const uint64_t *keystore_public_key(const keystore *ks, const keystore_entry *entry)
+{
+	return ks->keys[entry->record];
+};
+
+/* ----------------------------------------------------------------------------------------------- *
+   keystore_curve()
+   inputs: a keystore, and one of its entries;
+   output: the Edwards curve A of the entry (from the cache if present). It returns 1 if the record
+           is flagged KEYSTORE_VALIDATED, and 0 if A must still be validated by the caller.
+ * ----------------------------------------------------------------------------------------------- */
+uint8_t keystore_curve(proj A, const keystore *ks, const keystore_entry *entry)
+{
+	if (entry->flags & KEYSTORE_EDWARDS)
+		point_copy(A, ks->edwards[entry->record]);
+	else
+		expand_public_key(A, ks->keys[entry->record]);
+	return (entry->flags & KEYSTORE_VALIDATED) ? 1 : 0;
+};
+
+static int compare_entries(const void *a, const void *b)
+{
+	return strncmp(((const keystore_entry *)a)->name, ((const keystore_entry *)b)->name, KEYSTORE_NAME);
+};
+
+/* ----------------------------------------------------------------------------------------------- *
+   keystore_write()
+   inputs: n names (shorter than KEYSTORE_NAME and distinct) and their normalized public keys, and
+           whether the keys must be validated;
+   output: 0 on success and -1 on failure (the file is written to a temporary name and renamed, so
+           readers never map a partial keystore). With validated != 0, every key accepted by validate()
+           is flagged KEYSTORE_VALIDATED; the rejected ones are stored without the flag.
+ * ----------------------------------------------------------------------------------------------- */
+int keystore_write(const char *path, const char *names[], const fp keys[], size_t n, uint8_t validated)
+{
+	keystore_header header;
+	keystore_entry *index;
+	proj *edwards;
+	char tmp_path[4096];
+	FILE *out;
+	size_t i;
+	int ok;
+
+	if (snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path) >= (int)sizeof(tmp_path))
+		return -1;
+
+	index = calloc((n > 0) ? n : 1, sizeof(keystore_entry));
+	edwards = calloc((n > 0) ? n : 1, sizeof(proj));
+	if ((index == NULL) || (edwards == NULL))
+	{
+		free(index);
+		free(edwards);
+		return -1;
+	};
+
+	for (i = 0; i < n; i++)
+	{
+		if (strlen(names[i]) >= KEYSTORE_NAME)
+		{
+			free(index);
+			free(edwards);
+			return -1;
+		};
+		strcpy(index[i].name, names[i]);
+		index[i].record = i;
+		expand_public_key(edwards[i], keys[i]);
+		index[i].flags = KEYSTORE_EDWARDS;
+		if (validated && validate(edwards[i]))
+			index[i].flags |= KEYSTORE_VALIDATED;
+	};
+	qsort(index, n, sizeof(keystore_entry), compare_entries);
+	for (i = 1; i < n; i++)
+	{
+		if (compare_entries(&index[i - 1], &index[i]) == 0)
+		{
+			free(index);
+			free(edwards);
+			return -1;
+		};
+	};
+
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, KEYSTORE_MAGIC, sizeof(header.magic));
+	header.version = KEYSTORE_VERSION;
+	header.bits = KEYSTORE_BITS;
+	header.count = n;
+	header.index_offset = sizeof(keystore_header);
+	header.keys_offset = header.index_offset + n * sizeof(keystore_entry);
+	header.edwards_offset = header.keys_offset + n * sizeof(fp);
+
+	out = fopen(tmp_path, "wb");
+	ok = (out != NULL);
+	ok = ok && (fwrite(&header, sizeof(header), 1, out) == 1);
+	ok = ok && (fwrite(index, sizeof(keystore_entry), n, out) == n);
+	ok = ok && (fwrite(keys, sizeof(fp), n, out) == n);
+	ok = ok && (fwrite(edwards, sizeof(proj), n, out) == n);
+	if (out != NULL)
+		ok = (fclose(out) == 0) && ok;
+	ok = ok && (rename(tmp_path, path) == 0);
+	if (!ok)
+		unlink(tmp_path);
+
+	free(index);
+	free(edwards);
+	return ok ? 0 : -1;
+};
@@ -0,0 +1,349 @@
+#include <stdatomic.h>
+
+#include "parallel.h"
+#include "public_key.h"
+
+// Arguments of an action evaluated on a worker thread
+typedef struct {
+	proj *out;
+	const uint8_t *key;
+	const proj *in;
+	volatile uint8_t abort;		// set by the owner of the job for stopping the action
+} action_job;
+
+static void *action_worker(void *arg)
+{
+	action_job *job = (action_job *)arg;
+	ACTION_ABORT = &job->abort;
+	action_evaluation(*job->out, job->key, *job->in);
+	ACTION_ABORT = NULL;
+	return NULL;
+};
+
+/* ----------------------------------------------------------------------------------------------- *
+   csidh_encapsulation()
+   inputs: the (Edwards) public curve of the peer, pk_peer[0]:=a and pk_peer[1]:=(a - d);
+   output: a fresh secret key sk, its public curve pk = sk * E, and the shared curve ss = sk * pk_peer.
+           It returns 1 if pk_peer is a valid public curve, and 0 otherwise (pk, ss and sk are wiped).
+
+    NOTE: both actions use the same secret key but are independent of each other. Thus, sk * E is
+          computed on a second thread while the calling one validates pk_peer and computes sk * pk_peer.
+          The base curve E is public and valid, so it is not validated. If pk_peer is invalid, the
+          action on the second thread is cancelled as in csidh_speculative().
+ * ----------------------------------------------------------------------------------------------- */
+uint8_t csidh_encapsulation(proj pk, proj ss, uint8_t sk[], const proj pk_peer)
+{
+	pthread_t thread;
+	uint8_t valid, spawned;
+
+	random_key(sk);
+
+	action_job job = { .out = (proj *)pk, .key = sk, .in = (const proj *)E, .abort = 0 };
+	spawned = (pthread_create(&thread, NULL, action_worker, &job) == 0);
+	if (!spawned)
+		action_worker(&job);	// no second thread available: sk * E is computed sequentially
+
+	valid = validate(pk_peer);
+	if (valid)
+		action_evaluation(ss, sk, pk_peer);
+	else
+		job.abort = 1;	// sk * E is wiped anyway: the action is cancelled at its next round
+
+	if (spawned)
+		pthread_join(thread, NULL);
+
+	if (!valid)
+	{
+		explicit_bzero(sk, sizeof(uint8_t) * N);
+		explicit_bzero(pk, sizeof(proj));
+		explicit_bzero(ss, sizeof(proj));
+	};
+	return valid;
+};
+
+/* ----------------------------------------------------------------------------------------------- *
+   csidh_speculative()
+   inputs: a secret key, and a public curve in[0]:=a and in[1]:=(a - d);
+   output: the shared curve out = sk * in. It returns 1 if the public curve is valid, and 0 otherwise
+           (out is wiped).
+
+    NOTE: valid public curves are the common case, so the action is started on a second thread before
+          knowing whether the curve is valid; meanwhile, the calling thread runs validate(in). If the
+          validation fails, the action is cancelled at its next round. The output is only written once
+          the validation has succeeded, thus an invalid curve never yields a result.
+ * ----------------------------------------------------------------------------------------------- */
+uint8_t csidh_speculative(proj out, const uint8_t sk[], const proj in)
+{
+	pthread_t thread;
+	uint8_t valid;
+	proj speculative_out;
+
+	action_job job = { .out = (proj *)speculative_out, .key = sk, .in = (const proj *)in, .abort = 0 };
+	if (pthread_create(&thread, NULL, action_worker, &job) != 0)
+	{
+		// no second thread available: the usual sequential order
+		if (!validate(in))
+			return 0;
+		action_evaluation(out, sk, in);
+		return 1;
+	};
+
+	valid = validate(in);
+	if (!valid)
+		job.abort = 1;
+	pthread_join(thread, NULL);
+
+	if (valid)
+		point_copy(out, speculative_out);
+	else
+		explicit_bzero(out, sizeof(proj));
+	explicit_bzero(speculative_out, sizeof(proj));
+	return valid;
+};
+
+// Shared state of the workers of derive_many()
+typedef struct {
+	const uint8_t *key;
+	const fp *pks;
+	proj *ss;
+	uint8_t *valid;
+	size_t n;
+	atomic_size_t next;
+} derive_job;
+
+static void *derive_worker(void *arg)
+{
+	derive_job *job = (derive_job *)arg;
+	proj pk;
+	size_t i;
+
+	while ((i = atomic_fetch_add(&job->next, 1)) < job->n)
+	{
+		expand_public_key(pk, job->pks[i]);
+		job->valid[i] = validate(pk);	// invalid peers are rejected before any isogeny is built
+		if (job->valid[i])
+			action_evaluation(job->ss[i], job->key, pk);
+		else
+			point_copy(job->ss[i], E);	// placeholder with a non-zero (a - d) for the batched inversion
+	};
+	return NULL;
+};
+
+/* ----------------------------------------------------------------------------------------------- *
+   derive_many()
+   inputs: one secret key, n public keys (normalized Montgomery coefficients), and the number of threads;
+   output: the n normalized shared secrets out[i] = sk * pks[i], and valid[i] = 1 if pks[i] is a valid
+           public key (otherwise out[i] is zero). It returns the number of valid public keys.
+
+    NOTE: each worker takes the next peer, validates it and evaluates the action on it; the shared
+          curves are kept projective, and all of them are normalized at the end with a single inversion
+          instead of one per peer.
+ * ----------------------------------------------------------------------------------------------- */
+size_t derive_many(const uint8_t sk[], const fp pks[], size_t n, fp out[], uint8_t valid[], uint32_t threads)
+{
+	pthread_t *workers;
+	uint32_t spawned, t;
+	size_t i, count = 0;
+	derive_job job;
+
+	if (n == 0)
+		return 0;
+
+	job.key = sk;
+	job.pks = pks;
+	job.valid = valid;
+	job.n = n;
+	job.ss = malloc(n * sizeof(proj));
+	workers = calloc((threads > 1) ? threads - 1 : 1, sizeof(pthread_t));
+	if ((job.ss == NULL) || (workers == NULL))
+		exit(1);
+	atomic_init(&job.next, 0);
+
+	for (spawned = 0; (spawned + 1 < threads) && (spawned + 1 < n); spawned++)
+	{
+		if (pthread_create(&workers[spawned], NULL, derive_worker, &job) != 0)
+			break;
+	};
+	derive_worker(&job);	// the calling thread works too
+	for (t = 0; t < spawned; t++)
+		pthread_join(workers[t], NULL);
+
+	normalize_public_keys(job.ss, out, n);
+	for (i = 0; i < n; i++)
+	{
+		if (!valid[i])
+			memset(out[i], 0, sizeof(fp));
+		count += valid[i];
+	};
+
+	explicit_bzero(job.ss, n * sizeof(proj));
+	free(job.ss);
+	free(workers);
+	return count;
+};
+
+// One half of a level of cofactor_multiples(): P[lower] is multiplied by the l_i's of [from, to), and then
+// the subtree [lower, upper) is computed with at most `threads` threads
+typedef struct {
+	proj *P;
+	const proj *A;
+	int16_t lower, upper, from, to;
+	uint32_t threads;
+} cofactor_job;
+
+static void cofactor_multiples_parallel(proj P[], const proj A, int16_t lower, int16_t upper, uint32_t threads);
+
+static void *cofactor_worker(void *arg)
+{
+	cofactor_job *job = (cofactor_job *)arg;
+	for (int16_t i = job->from; i < job->to; ++i)
+		yMUL(job->P[job->lower], job->P[job->lower], *job->A, i);
+	cofactor_multiples_parallel(job->P, *job->A, job->lower, job->upper, job->threads);
+	return NULL;
+};
+
+/* The same tree as cofactor_multiples(): once P[lower] is copied into P[mid], both halves are independent,
+ * so the first one goes to a new thread with half of the threads. */
+static void cofactor_multiples_parallel(proj P[], const proj A, int16_t lower, int16_t upper, uint32_t threads)
+{
+	pthread_t thread;
+	uint8_t spawned;
+
+	if ((threads < 2) || ((upper - lower) < 2))
+	{
+		cofactor_multiples(P, A, lower, upper);
+		return;
+	};
+
+	int16_t mid = lower + (upper - lower + 1) / 2;
+	point_copy(P[mid], P[lower]);
+
+	cofactor_job left = { .P = P, .A = (const proj *)A, .lower = lower, .upper = mid, .from = mid, .to = upper,
+	                      .threads = threads / 2 };
+	cofactor_job right = { .P = P, .A = (const proj *)A, .lower = mid, .upper = upper, .from = lower, .to = mid,
+	                       .threads = threads - threads / 2 };
+	spawned = (pthread_create(&thread, NULL, cofactor_worker, &left) == 0);
+	if (!spawned)
+		cofactor_worker(&left);	// no second thread available: both halves on this one
+	cofactor_worker(&right);
+	if (spawned)
+		pthread_join(thread, NULL);
+};
+
+// Outcome of the check of [(p+1)/l_i] P in validate()
+#define ORDER_PENDING  0
+#define ORDER_INFINITY 1	// [(p+1)/l_i] P is the infinity point: nothing is learnt from l_i
+#define ORDER_L        2	// [(p+1)/l_i] P has order l_i
+#define ORDER_WRONG    3	// [(p+1)/l_i] P does not have order l_i: P does not have order dividing p+1
+
+// Shared state of the threads checking the orders: the l_i's are taken from N - 1 down to 0, and the
+// outcomes are replayed in that order (the order of validate()) as soon as they are known
+typedef struct {
+	proj *P;
+	const proj *A;
+	uint8_t order[N];
+	int16_t next, replayed;		// next l_i to check, and next l_i to replay
+	uint16_t bits_of_the_order;
+	int8_t valid;			// -1 while undecided, 0 or 1 once decided, and 2 if P is not enough
+	pthread_mutex_t lock;
+} order_job;
+
+static void *order_worker(void *arg)
+{
+	order_job *job = (order_job *)arg;
+	int16_t i;
+	uint8_t order;
+
+	while (1)
+	{
+		pthread_mutex_lock(&job->lock);
+		i = (job->valid < 0) ? job->next-- : -1;
+		pthread_mutex_unlock(&job->lock);
+		if (i < 0)
+			break;
+
+		order = ORDER_INFINITY;
+		if (isinfinity(job->P[i]) != 1)
+		{
+			yMUL(job->P[i], job->P[i], *job->A, i);
+			order = (isinfinity(job->P[i]) != 1) ? ORDER_WRONG : ORDER_L;
+		};
+
+		pthread_mutex_lock(&job->lock);
+		job->order[i] = order;
+		while ((job->valid < 0) && (job->replayed >= 0) && (job->order[job->replayed] != ORDER_PENDING))
+		{
+			if (job->order[job->replayed] == ORDER_WRONG)
+				job->valid = 0;
+			else if (job->order[job->replayed] == ORDER_L)
+			{
+				job->bits_of_the_order += BITS_OF_L[job->replayed];
+				if (job->bits_of_the_order > BITS_OF_4SQRT_OF_P)
+					job->valid = 1;	// order > 4 sqrt(p), hence definitely supersingular
+			};
+			job->replayed -= 1;
+		};
+		if ((job->valid < 0) && (job->replayed < 0))
+			job->valid = 2;
+		pthread_mutex_unlock(&job->lock);
+	};
+	return NULL;
+};
+
+/* ----------------------------------------------------------------------------------------------- *
+   validate_parallel()
+   inputs: a public curve A[0]:=a and A[1]:=(a - d), and the number of threads;
+   output: 1 if A is supersingular, and 0 otherwise, exactly as validate() (same random points, same
+           early exit once the order of the point exceeds 4 sqrt(p)).
+
+    NOTE: the two halves of each level of the tree of cofactor_multiples() are split across the
+          threads, and so are the final checks [l_i] ([(p+1)/l_i] P) = infinity. The checks are taken in
+          the order of validate() and the threads stop taking new ones once the outcome is decided.
+          With threads < 2 it is validate(). The field operations of the other threads are not counted.
+ * ----------------------------------------------------------------------------------------------- */
+uint8_t validate_parallel(const proj A, uint32_t threads)
+{
+	pthread_t *workers;
+	uint32_t spawned, t;
+	int8_t valid;
+
+	if (threads < 2)
+		return validate(A);
+
+	workers = calloc(threads - 1, sizeof(pthread_t));
+	if (workers == NULL)
+		exit(1);
+
+	do {
+
+		proj P[N];
+
+		fp_random_montgomery(P[0][0]);	// uniform on F_p
+
+		set_zero(P[0][1], NUMBER_OF_WORDS);
+		fp_add(P[0][1], P[0][1], R_mod_p);	// Z is set to 1 (in montgomery domain)
+
+		yQUAD(P[0], P[0], A); // mult. by [4]
+
+		cofactor_multiples_parallel(P, A, 0, N, threads);
+
+		order_job job = { .P = P, .A = (const proj *)A, .order = {0}, .next = N - 1, .replayed = N - 1,
+		                  .bits_of_the_order = 0, .valid = -1 };
+		pthread_mutex_init(&job.lock, NULL);
+		for (spawned = 0; spawned + 1 < threads; spawned++)
+		{
+			if (pthread_create(&workers[spawned], NULL, order_worker, &job) != 0)
+				break;
+		};
+		order_worker(&job);	// the calling thread checks too
+		for (t = 0; t < spawned; t++)
+			pthread_join(workers[t], NULL);
+		pthread_mutex_destroy(&job.lock);
+		valid = job.valid;
+
+		/* P didn't have big enough order to prove supersingularity: another one */
+	} while (valid == 2);
+
+	free(workers);
+	return (uint8_t)valid;
+};
@@ -1,5 +1,11 @@
 #include "edwards_curve.h"
 
+__thread uint64_t FP_ADD_COMPUTED = 0,
+		 FP_SQR_COMPUTED = 0,
+		 FP_MUL_COMPUTED = 0;
+
+__thread volatile uint8_t *ACTION_ABORT = NULL;
+
 /* ------------------------------------------------------------- *
    isinfinity()
    inputs: the projective Edwards y-coordinates of y(P)=YP/ZP;
@@ -107,40 +113,215 @@ void yADD(proj R, const proj P, const proj Q, const proj PQ)
 	FP_MUL_COMPUTED += 4;
 };// Cost : 4M + 2S + 6a
 
+/* ---------------------------------------------------------------------- *
+   yQUAD()
+   inputs: the projective Edwards y-coordinates of y(P)=YP/ZP, and the
+           Edwards curve constant A[0]:=a, and A[1]:=(a - d);
+   output: the projective Edwards y-coordinates y([4]P)
+
+    NOTE: the squarings of the second doubling are the mapping of the
+          first one into the Edwards curve, so there is nothing else to
+          share: a quadrupling costs as two doublings.
+ * ---------------------------------------------------------------------- */
+void yQUAD(proj Q, const proj P, const proj A)
+{
+	yDBL(Q, P, A);
+	yDBL(Q, Q, A);
+};// Cost : 8M + 4S + 8a
+
+/* ---------------------------------------------------------------------- *
+   yTPL()
+   inputs: the projective Edwards y-coordinates of y(P)=YP/ZP, and the
+           Edwards curve constant A[0]:=a, and A[1]:=(a - d);
+   output: the projective Edwards y-coordinates y([3]P)
+
+    NOTE: the tripling of the isomorphic Montgomery curve, whose constants
+          (A + 2C) and (A - 2C) are proportional to a and d. YP and ZP
+          already are (X - Z) and (X + Z) of the Montgomery point. It is
+          not cheaper than yDBL() plus yADD() (8M + 4S + 10a): as many
+          products, fp_sqr() being fp_mul(), and one more addition. Thus
+          yMUL() keeps its chain of length 0 for l = 3.
+ * ---------------------------------------------------------------------- */
+void yTPL(proj Q, const proj P, const proj A)
+{
+	fp tmp_0, tmp_1, tmp_2, tmp_3, tmp_4, tmp_5, tmp_6, tmp_d;
+
+	fp_sub(tmp_d, A[0], A[1]);		// d
+	fp_sqr(tmp_2, P[0]);			// (X - Z)^2
+	fp_sqr(tmp_3, P[1]);			// (X + Z)^2
+	fp_add(tmp_4, P[1], P[0]);		// 2X
+	fp_sub(tmp_0, P[1], P[0]);		// 2Z
+	fp_sqr(tmp_1, tmp_4);			// 4X^2
+	fp_sub(tmp_1, tmp_1, tmp_3);
+	fp_sub(tmp_1, tmp_1, tmp_2);		// 4X^2 - (X + Z)^2 - (X - Z)^2
+
+	fp_mul(tmp_5, A[0], tmp_3);		// a(X + Z)^2
+	fp_mul(tmp_3, tmp_3, tmp_5);		// a(X + Z)^3
+	fp_mul(tmp_6, tmp_d, tmp_2);		// d(X - Z)^2
+	fp_mul(tmp_2, tmp_2, tmp_6);		// d(X - Z)^3
+	fp_sub(tmp_3, tmp_2, tmp_3);
+	fp_sub(tmp_2, tmp_5, tmp_6);
+	fp_mul(tmp_1, tmp_1, tmp_2);
+
+	fp_add(tmp_2, tmp_3, tmp_1);
+	fp_sqr(tmp_2, tmp_2);
+	fp_mul(tmp_2, tmp_2, tmp_4);		// X of [3]P
+	fp_sub(tmp_1, tmp_3, tmp_1);
+	fp_sqr(tmp_1, tmp_1);
+	fp_mul(tmp_1, tmp_1, tmp_0);		// Z of [3]P
+
+	// Lastly, the result is mapping into the Edward's curve
+	fp_sub(Q[0], tmp_2, tmp_1);
+	fp_add(Q[1], tmp_2, tmp_1);
+
+	FP_ADD_COMPUTED += 11;
+	FP_SQR_COMPUTED += 5;
+	FP_MUL_COMPUTED += 7;
+};// Cost : 7M + 5S + 11a
+
+/* ---------------------------------------------------------------------- *
+   fp_select()
+   inputs: two field elements a and b, and a mask m (0 or 1);
+   output: c = a if m = 1, and c = b if m = 0 (in constant-time)
+ * ---------------------------------------------------------------------- */
+static inline void fp_select(fp c, const fp a, const fp b, uint64_t m)
+{
+	uint64_t mask = -m;
+	for (int k = 0; k < NUMBER_OF_WORDS; k++)
+		c[k] = b[k] ^ (mask & (a[k] ^ b[k]));
+};
+
+/* ---------------------------------------------------------------------- *
+   yADD_or_DBL()
+   inputs: the projective Edwards y-coordinates of y(P)=YP/ZP, y(Q)=YQ/ZQ,
+           and y(P-Q)=YPQ/ZPQ, and the Edwards curve constant A[0]:=a, and
+           A[1]:=(a - d);
+   output: the projective Edwards y-coordinates of y(P+Q), that is y([2]P)
+           when P-Q is the infinity point (Q is then P up to a projective
+           factor)
+
+    NOTE: yADD() and yDBL() are both three rounds of two multiplications,
+          thus the same 6M compute either one, with the operands chosen by
+          constant-time selections: the squarings of yADD() are made
+          multiplications, and the first two products of yDBL() take one
+          factor from Q. Whether P-Q is the infinity point is read from the
+          Montgomery Z-coordinate of the difference, which yADD() computes
+          anyway (no subtraction nor comparison of its own). Against yADD()
+          (4M + 2S + 6a), it costs one more addition, and seven selections.
+ * ---------------------------------------------------------------------- */
+static void yADD_or_DBL(proj R, const proj P, const proj Q, const proj PQ, const proj A)
+{
+	fp xD, zD, P0, P1, t0, t1, s, u, x, y, w, v;
+	uint64_t m;
+
+	// The difference mapped into the isomorphic Montgomery curve: it is the infinity point iff zD = 0
+	fp_add(xD, PQ[1], PQ[0]);
+	fp_sub(zD, PQ[1], PQ[0]);
+	m = (uint64_t)iszero(zD, NUMBER_OF_WORDS);	// constant-time: an OR of the words
+
+	// (P[1]*Q[0], P[0]*Q[1]) for yADD(), and (P[0]*Q[0], P[1]*Q[1]) ~ (P[0]^2, P[1]^2) for yDBL()
+	fp_select(P0, P[1], P[0], m);
+	fp_select(P1, P[0], P[1], m);
+	fp_mul(t0, P1, Q[0]);
+	fp_mul(t1, P0, Q[1]);
+
+	fp_add(s, t0, t1);
+	fp_sub(u, t0, t1);
+
+	// (s^2, u^2) for yADD(), and ((a - d)*t0, a*u) for yDBL()
+	fp_select(x, A[1], s, m);
+	fp_select(y, t0, s, m);
+	fp_mul(w, x, y);
+	fp_select(y, A[0], u, m);
+	fp_mul(v, u, y);
+
+	// (w*zD, v*xD) for yADD(), and (w*t1, (v - w)*u) for yDBL()
+	fp_select(y, t1, zD, m);
+	fp_mul(x, w, y);
+	set_zero(y, NUMBER_OF_WORDS);
+	fp_select(y, w, y, m);
+	fp_sub(v, v, y);
+	fp_select(y, u, xD, m);
+	fp_mul(v, v, y);
+
+	// Lastly, the result is mapping into the Edward's curve
+	fp_sub(R[0], x, v);
+	fp_add(R[1], x, v);
+
+	FP_ADD_COMPUTED += 7;
+	FP_MUL_COMPUTED += 6;
+};// Cost : 6M + 7a
+
 /* ---------------------------------------------------------------------- *
    yMUL()
    inputs: the projective Edwards y-coordinates of y(P)=YP/ZP, the Edwards 
            curve constant A[0]:=a, and A[1]:=(a - d), and an positive 
            integer integer number 0 <= i <= (N - 1);
    output: the projective Edwards y-coordinates y([l_i]P)
+
+    NOTE: the 3-tuple is rotated through the indices r[], the new point
+          overwriting the difference (which is no longer needed). When the
+          difference is the point at infinity (the order of P divides an
+          element of the chain), the step must be a doubling: every step is
+          a yADD_or_DBL(), which costs the same in both cases. The chain
+          bits are public.
  * ---------------------------------------------------------------------- */
 void yMUL(proj Q, const proj P, const proj A, uint8_t const i)
 {
-	proj R[3], T;
+	proj R[3];
+	uint8_t r[3] = {0, 1, 2}, b, j;
 
-	// Initial 3-tuple of points	
+	// Initial 3-tuple of points
 	point_copy(R[0], P);		// P
 	yDBL(R[1], P, A);		// [2]P
 	yADD(R[2], R[1], R[0], P);	// [3]P
 
-	// main loop
-	uint8_t j;
-	uint32_t tmp = ADDITION_CHAIN[i];
+	// main loop: (R[r[0]], R[r[1]], R[r[2]]) <- (R[r[b ^ 1]], R[r[2]], R[r[2]] + R[r[b ^ 1]])
+	uint64_t tmp = ADDITION_CHAIN[i];
 	for(j = 0; j < ADDITION_CHAIN_LENGTH[i]; j++)
 	{
-		if (isinfinity(R[tmp & 0x1]) == 1)
-			yDBL(T, R[2], A);
-		else
-			yADD(T, R[2], R[(tmp & 0x1) ^ 0x1], R[tmp & 0x1]);
-		// updating
-		point_copy(R[0], R[(tmp & 0x1) ^ 0x1]);
-		point_copy(R[1], R[2]);
-		point_copy(R[2], T);
-		
+		b = tmp & 0x1;
+		yADD_or_DBL(R[r[b]], R[r[2]], R[r[b ^ 0x1]], R[r[b]], A);
+		uint8_t t = r[b];
+		r[0] = r[b ^ 0x1];
+		r[1] = r[2];
+		r[2] = t;
+
 		tmp >>= 1;
 	};
-	point_copy(Q, R[2]);	// At last, R[2] is equal to [l_{i}]P
-};// Cost ~ 1.5*Ceil[log_2(l)]*(4M + 2S)
+
+	point_copy(Q, R[r[2]]);	// At last, R[r[2]] is equal to [l_{i}]P
+};// Cost ~ 1.5*Ceil[log_2(l)]*(6M + 7a), and seven selections per step
+
+/* ------------------------------------------------------------------------------- *
+   fp_random_montgomery()
+   output: a random element of F_p in the Montgomery domain.
+
+    NOTE: a (64*NUMBER_OF_WORDS + 64)-bits integer w = low + high*2^(64*NUMBER_OF_WORDS)
+          is drawn and reduced modulo p, which has statistical distance < p/2^(64 *
+          NUMBER_OF_WORDS + 64) from the uniform distribution. The reduction and the
+          mapping into the Montgomery domain are merged: w*R = low*R^2/R + high*R^3/R.
+          There is no rejection loop, so the running time does not depend on w.
+ * ------------------------------------------------------------------------------- */
+void fp_random_montgomery(fp x)
+{
+	uint64_t wide[NUMBER_OF_WORDS + 1] __attribute__((aligned(64)));
+	fp high;
+
+	randombytes(wide, sizeof(wide));
+	set_zero(high, NUMBER_OF_WORDS);
+	high[0] = wide[NUMBER_OF_WORDS];
+
+	fp_mul(x, wide, R_squared_mod_p);	// low * R mod p (fp_mul accepts any input smaller than 2^(64*NUMBER_OF_WORDS))
+	fp_mul(high, high, R_cubed_mod_p);	// high * 2^(64*NUMBER_OF_WORDS) * R mod p
+	fp_add(x, x, high);
+
+	explicit_bzero(wide, sizeof(wide));
+	explicit_bzero(high, sizeof(fp));
+
+	FP_ADD_COMPUTED += 1;
+	FP_MUL_COMPUTED += 2;
+};// Cost : 2M + 1a
 
 /* ------------------------------------------------------------------------------- *
    elligator()
@@ -156,13 +337,13 @@ void elligator(proj T_plus, proj T_minus, const proj A)
 	set_zero(T_plus[0], NUMBER_OF_WORDS);			// Initial value is zero
 	set_zero(T_minus[0], NUMBER_OF_WORDS);			// Initial value is zero
 
-	// u is randomly selecting from {2, ..., (p-1)/2}
+	// u is randomly selected from F_p (already in the Montgomery domain). Only u^2 determines the pair
+	// {T_{+}, T_{-}} when A' != 0, and u -> -u swaps y(T_{+}) and y(T_{-}) when A' = 0 (which are then
+	// sorted by the Legendre symbol below). Thus, u and -u give the same output, and sampling u from F_p
+	// is the same as sampling it from {2, ..., (p-1)/2} without the rejection loop (u in {0, 1, -1}
+	// happens with negligible probability).
 	fp u;
-	fp_random(u);
-	while ( compare(u, (uint64_t *)p_minus_1_halves, NUMBER_OF_WORDS) > 0)
-		fp_random(u);
-
-	fp_mul(u, u, R_squared_mod_p);	// mapping u into the Montgomery domain
+	fp_random_montgomery(u);
 
 	// ---
 	fp tmp, u2_plus_1, Cu2_minus_1, tmp_0, tmp_1, alpha, beta;
@@ -218,27 +399,25 @@ void elligator(proj T_plus, proj T_minus, const proj A)
 	FP_ADD_COMPUTED += 16;
 	FP_SQR_COMPUTED += 3;
 	FP_MUL_COMPUTED += 8;
-
-	FP_MUL_COMPUTED += 1;	// This multiplication is for mapping the input u<-{2, ..., (p-1)/2} into the Montgomery domain
-};// Cost : 1(legendre s.) + 8M + 3S + 16a
+};// Cost : 1(legendre s.) + 8M + 3S + 16a (plus 2M + 1a for sampling u)
 
 /* compute [(p+1)/l] P for all l in our list of primes. */
 /* divide and conquer is much faster than doing it naively,
  * but uses more memory. */
-void cofactor_multiples(proj P[], const proj A, int8_t lower, int8_t upper)
+void cofactor_multiples(proj P[], const proj A, int16_t lower, int16_t upper)
 {
 	assert(lower < upper);
 
 	if ( (upper - lower) == 1)
 		return;
 
-	int8_t mid = lower + (upper - lower + 1) / 2;
+	int16_t mid = lower + (upper - lower + 1) / 2;	// N may exceed 127 (see tools/csidh_params.py)
 
 	point_copy(P[mid], P[lower]);
-	for (int8_t i = lower; i < mid; ++i)
+	for (int16_t i = lower; i < mid; ++i)
 		yMUL(P[mid], P[mid], A, i);
 
-	for (int8_t i = mid; i < upper; ++i)
+	for (int16_t i = mid; i < upper; ++i)
 		yMUL(P[lower], P[lower], A, i);
 
 	cofactor_multiples(P, A, lower, mid);
@@ -252,15 +431,12 @@ uint8_t validate(const proj A)
 
 		proj P[N];
 
-		fp_random(P[0][0]);
-		while ( compare(P[0][0], (uint64_t *)p, NUMBER_OF_WORDS) > 0)
-			fp_random(P[0][0]);
+		fp_random_montgomery(P[0][0]);	// uniform on F_p
 
 		set_zero(P[0][1], NUMBER_OF_WORDS);
 		fp_add(P[0][1], P[0][1], R_mod_p);	// Z is set to 1 (in montgomery domain)
 		
-		yDBL(P[0], P[0], A); // mult. by [2]
-		yDBL(P[0], P[0], A); // mult. by [2]
+		yQUAD(P[0], P[0], A); // mult. by [4]
 
 		cofactor_multiples(P, A, 0, N);
 
@@ -0,0 +1,65 @@
+#include "public_key.h"
+
+void normalize_public_key(proj public_key, fp *out) {
+    /* Compress the public key from x,y (256 bits) to x/y,NULL (128 bits) */
+    // public_key has entries x,y or public_key[0] and public_key[1]
+    fp n_public_key;
+    fp_inv(public_key[1]); // fp_inv becomes x,1/y or public_key[0] = x and public_key[1] = 1/y
+    fp_mul(n_public_key, public_key[0], public_key[1]); // normalized_public_key is x*1/y or x/y aka public_key[0]/public_key[1]
+    /* Convert to Montgomery form */
+    fp_mul(n_public_key, n_public_key, E[1]); // x/y * 4
+    fp_sub(n_public_key, n_public_key, E[0]); // x/y - 2
+    memcpy(out, n_public_key, sizeof(fp));
+}
+
+/*
+ * Same as normalize_public_key() for n curves at once, with a single inversion (Montgomery's trick):
+ * the inverse of y_i is recovered from the inverse of y_0 * ... * y_{n-1} with three multiplications.
+ * Every y_i must be non-zero; the curves are left untouched.
+ */
+void normalize_public_keys(proj public_keys[], fp out[], size_t n) {
+    fp *prefix, inverse, tmp;
+    size_t i;
+
+    if (n == 0)
+        return;
+    if ((prefix = malloc(n * sizeof(fp))) == NULL)
+        exit(1);
+
+    memcpy(prefix[0], public_keys[0][1], sizeof(fp));
+    for (i = 1; i < n; ++i)
+        fp_mul(prefix[i], prefix[i - 1], public_keys[i][1]); // y_0 * ... * y_i
+    memcpy(inverse, prefix[n - 1], sizeof(fp));
+    fp_inv(inverse); // 1 / (y_0 * ... * y_{n-1})
+
+    for (i = n - 1; i > 0; --i) {
+        fp_mul(tmp, inverse, prefix[i - 1]); // 1 / y_i
+        fp_mul(inverse, inverse, public_keys[i][1]); // 1 / (y_0 * ... * y_{i-1})
+        fp_mul(out[i], public_keys[i][0], tmp);
+        fp_mul(out[i], out[i], E[1]);
+        fp_sub(out[i], out[i], E[0]);
+    }
+    fp_mul(out[0], public_keys[0][0], inverse);
+    fp_mul(out[0], out[0], E[1]);
+    fp_sub(out[0], out[0], E[0]);
+
+    explicit_bzero(prefix, n * sizeof(fp));
+    explicit_bzero(inverse, sizeof(fp));
+    explicit_bzero(tmp, sizeof(fp));
+    free(prefix);
+}
+
+void expand_public_key(proj expanded_public_key, const fp public_key) {
+    /* Expand the normalized key and convert from Montgomery to Edwards form. */
+    /*
+     * If one wanted to use Edwards rather than Montgomery, the three lines
+     * below could be replaced with the following two lines:
+     *
+     *  memcpy(expanded_public_key[1], R_mod_p, (sizeof(expanded_public_key[1])));
+     *  memcpy(expanded_public_key[0], public_key, (sizeof(expanded_public_key[0])));
+     *
+     * */
+    memcpy(expanded_public_key[1], E[1], (sizeof(expanded_public_key[1]))); // E[1] ==2
+    memcpy(expanded_public_key[0], public_key, (sizeof(expanded_public_key[0]))); // Original value from user in Montgomery form
+    fp_add(expanded_public_key[0], expanded_public_key[0], E[0]); // E[0] == 4
+}
@@ -0,0 +1,374 @@
+#include "edwards_curve.h"
+
+/* ----------------------------------------------------------------------------------------------- *
+   Radical isogenies (Castryck, Decru and Vercauteren): on a curve in Tate normal form with the
+   point (0, 0) of order l, the next curve of the chain of degree-l isogenies is a rational function
+   of an l-th root. As p = -1 mod l, the l-th root of x is the power x^((m(p - 1) + 1) / l) with
+   m = (l + 1) / 2, and each step costs one exponentiation: no torsion point is required but the
+   first one, which puts the curve in Tate normal form.
+
+    l = 3: E : y^2 + a1 xy + a3 y = x^3,  alpha = (-a3)^(1/3),
+           a1' = a1 - 6 alpha, and a3' = 3 a1 alpha^2 - a1^2 alpha + 9 a3;
+    l = 5: E : y^2 + (1 - b) xy - b y = x^3 - b x^2,  rho = b^(1/5),
+           b' = rho (rho^4 + 3 rho^3 + 4 rho^2 + 2 rho + 1) / (rho^4 - 2 rho^3 + 4 rho^2 - 3 rho + 1).
+
+   The l = 5 chain keeps b = N / D projectively: with r = (N D^4)^(1/5), rho = r / D.
+ * ----------------------------------------------------------------------------------------------- */
+
+/* ------------------------------------------------------------- *
+   exponent()
+   inputs: the integers m, c and d such that d divides (m p + c);
+   output: the exponent (m p + c) / d, as an integer of
+           NUMBER_OF_WORDS words (m <= d is required)
+ * ------------------------------------------------------------- */
+static void exponent(uint64_t e[], const uint64_t m, const int64_t c, const uint64_t d)
+{
+	uint64_t t[NUMBER_OF_WORDS + 1];
+	unsigned __int128 w = 0;
+	int j;
+
+	// t <- m p + c
+	for (j = 0; j < NUMBER_OF_WORDS; j++)
+	{
+		w += (unsigned __int128)m * p[j];
+		t[j] = (uint64_t)w;
+		w >>= 64;
+	};
+	t[NUMBER_OF_WORDS] = (uint64_t)w;
+
+	w = (unsigned __int128)((c < 0) ? -c : c);
+	for (j = 0; j <= NUMBER_OF_WORDS; j++)
+	{
+		if (c < 0)
+		{
+			uint64_t borrow = (t[j] < (uint64_t)w);
+			t[j] -= (uint64_t)w;
+			w = borrow;
+		}
+		else
+		{
+			w += t[j];
+			t[j] = (uint64_t)w;
+			w >>= 64;
+		};
+	};
+
+	// e <- t / d
+	w = 0;
+	for (j = NUMBER_OF_WORDS; j >= 0; j--)
+	{
+		w = (w << 64) | t[j];
+		if (j < NUMBER_OF_WORDS)
+			e[j] = (uint64_t)(w / d);
+		w %= d;
+	};
+};
+
+/* ------------------------------------------------------------- *
+   fp_pow()
+   inputs: an element a of F_p and a public exponent e of
+           NUMBER_OF_WORDS words;
+   output: a^e (left-to-right, the running time only depends on e)
+ * ------------------------------------------------------------- */
+static void fp_pow(fp b, const fp a, const uint64_t e[])
+{
+	fp t;
+	int j, k;
+
+	copy(t, a, NUMBER_OF_WORDS);
+	for (k = NUMBER_OF_WORDS * 64 - 1; ((e[k >> 6] >> (k & 63)) & 1) == 0; k--);	// leading bit
+
+	for (j = k - 1; j >= 0; j--)
+	{
+		fp_sqr(t, t);
+		FP_SQR_COMPUTED += 1;
+		if (((e[j >> 6] >> (j & 63)) & 1) == 1)
+		{
+			fp_mul(t, t, a);
+			FP_MUL_COMPUTED += 1;
+		};
+	};
+	copy(b, t, NUMBER_OF_WORDS);
+};
+
+/* ------------------------------------------------------------- *
+   fp_integer()
+   inputs: a small integer k;
+   output: k in the Montgomery domain
+ * ------------------------------------------------------------- */
+static void fp_integer(fp x, const uint64_t k)
+{
+	set_zero(x, NUMBER_OF_WORDS);
+	x[0] = k;
+	fp_mul(x, x, R_squared_mod_p);
+	FP_MUL_COMPUTED += 1;
+};
+
+/* ------------------------------------------------------------- *
+   radical_step_3() and radical_step_5()
+   inputs: a curve in Tate normal form, s[] = (a1, a3) for l = 3
+           and s[] = (N, D) with b = N / D for l = 5, and the
+           exponent of the l-th roots;
+   output: the next curve of the chain
+ * ------------------------------------------------------------- */
+static void radical_step_3(fp t[2], const fp s[2], const uint64_t root[])
+{
+	fp alpha, alpha_2, tmp_0, tmp_1;
+
+	set_zero(tmp_0, NUMBER_OF_WORDS);
+	fp_sub(tmp_0, tmp_0, s[1]);
+	fp_pow(alpha, tmp_0, root);		// alpha = (-a3)^(1/3)
+	fp_sqr(alpha_2, alpha);
+
+	fp_sub(tmp_0, alpha_2, alpha);		// alpha^2 - alpha
+	fp_mul(tmp_1, s[0], alpha);		// a1 alpha
+	fp_add(tmp_0, alpha_2, alpha_2);
+	fp_add(tmp_0, tmp_0, alpha_2);		// 3 alpha^2
+	fp_sub(tmp_0, tmp_0, tmp_1);		// 3 alpha^2 - a1 alpha
+	fp_mul(tmp_0, tmp_0, s[0]);		// 3 a1 alpha^2 - a1^2 alpha
+	fp_add(tmp_1, s[1], s[1]);
+	fp_add(tmp_1, tmp_1, s[1]);
+	fp_add(t[1], tmp_1, tmp_1);
+	fp_add(t[1], t[1], tmp_1);		// 9 a3
+	fp_add(t[1], t[1], tmp_0);		// a3'
+
+	fp_add(tmp_0, alpha, alpha);
+	fp_add(tmp_1, tmp_0, tmp_0);
+	fp_add(tmp_0, tmp_0, tmp_1);		// 6 alpha
+	fp_sub(t[0], s[0], tmp_0);		// a1'
+
+	FP_ADD_COMPUTED += 14;
+	FP_SQR_COMPUTED += 1;
+	FP_MUL_COMPUTED += 2;
+};// Cost : 1(l-th root) + 2M + 1S + 14a
+
+static void radical_step_5(fp t[2], const fp s[2], const uint64_t root[])
+{
+	fp r[5], d[5], tmp_0, tmp_1, tmp_2;
+
+	fp_sqr(d[2], s[1]);				// D^2
+	fp_mul(d[3], d[2], s[1]);			// D^3
+	fp_sqr(d[4], d[2]);				// D^4
+	fp_mul(tmp_0, s[0], d[4]);			// N D^4
+	fp_pow(r[1], tmp_0, root);			// r = (N D^4)^(1/5)
+	fp_sqr(r[2], r[1]);
+	fp_mul(r[3], r[2], r[1]);
+	fp_sqr(r[4], r[2]);
+
+	fp_mul(r[3], r[3], s[1]);			// r^3 D
+	fp_mul(r[2], r[2], d[2]);			// r^2 D^2
+	fp_mul(d[3], d[3], r[1]);			// r D^3
+
+	fp_add(tmp_0, r[4], d[4]);			// r^4 + D^4
+	fp_add(tmp_1, r[2], r[2]);
+	fp_add(tmp_1, tmp_1, tmp_1);
+	fp_add(tmp_0, tmp_0, tmp_1);			// r^4 + 4 r^2 D^2 + D^4
+
+	fp_add(tmp_1, r[3], r[3]);			// 2 r^3 D
+	fp_add(tmp_2, d[3], d[3]);			// 2 r D^3
+	fp_add(t[0], tmp_0, tmp_1);
+	fp_add(t[0], t[0], r[3]);
+	fp_add(t[0], t[0], tmp_2);			// r^4 + 3 r^3 D + 4 r^2 D^2 + 2 r D^3 + D^4
+	fp_sub(t[1], tmp_0, tmp_1);
+	fp_sub(t[1], t[1], tmp_2);
+	fp_sub(t[1], t[1], d[3]);			// r^4 - 2 r^3 D + 4 r^2 D^2 - 3 r D^3 + D^4
+
+	fp_mul(t[0], t[0], r[1]);			// N'
+	fp_mul(t[1], t[1], s[1]);			// D'
+
+	FP_ADD_COMPUTED += 12;
+	FP_SQR_COMPUTED += 4;
+	FP_MUL_COMPUTED += 8;
+};// Cost : 1(l-th root) + 8M + 4S + 12a
+
+/* ----------------------------------------------------------------------------------------------- *
+   radical_isogenies()
+   inputs: the Edwards curve constants A[0]:=a and A[1]:=(a - d), an integer 0 <= i < N such that
+           L[i] = 3 or 5, the (secret) number of steps 0 <= e <= bound and its (secret) direction
+           positive in {0, 1};
+   output: the Edwards curve constants C[0]:=a' and C[1]:=(a' - d') of the curve reached by e
+           degree-L[i] isogenies (whose kernels have their affine points of the Montgomery curve in
+           F_p if positive = 1, and in F_{p^2}\F_p otherwise)
+
+    NOTE: the walk always costs bound steps (the last bound - e are computed and discarded), and
+          the direction is the twist, i.e., swapping a and d: only the search of the point of order
+          L[i] depends on the randomness. The starting curve is converted into Tate normal form
+          with the point of order L[i], and the last one into a Montgomery curve by the root of its
+          2-division polynomial in F_p (Cardano's formula).
+ * ----------------------------------------------------------------------------------------------- */
+void radical_isogenies(proj C, const proj A, const uint8_t i, const uint8_t e, const uint8_t positive,
+                       const uint8_t bound)
+{
+	uint64_t root[NUMBER_OF_WORDS], square_root[NUMBER_OF_WORDS], inverse_square_root[NUMBER_OF_WORDS],
+	         inverse[NUMBER_OF_WORDS];
+	fp a, d, x, y, w, tmp_0, tmp_1, tmp_2;
+	fp s[2], t[2];
+	proj curve, T[2];
+	uint8_t j, k;
+
+	exponent(root, (L[i] + 1) >> 1, 1 - (int64_t)((L[i] + 1) >> 1), L[i]);	// x^(1/l)
+	exponent(square_root, 1, 1, 4);							// x^(1/2), p = 3 mod 4
+	exponent(inverse_square_root, 1, -3, 4);					// x^(-1/2), a square
+	exponent(inverse, 1, -2, 1);							// x^(-1)
+
+	// The walk is on the twist (a and d swapped) in the negative direction
+	copy(a, A[0], NUMBER_OF_WORDS);
+	fp_sub(d, A[0], A[1]);
+	fp_cswap(a, d, positive ^ 1);
+	copy(curve[0], a, NUMBER_OF_WORDS);
+	fp_sub(curve[1], a, d);
+
+	// A point of order L[i] whose affine Montgomery x-coordinate belongs to F_p
+	do {
+		elligator(T[0], T[1], curve);
+		yQUAD(T[0], T[0], curve);
+		for (j = 0; j < N; j++)
+		{
+			if (j != i)
+				yMUL(T[0], T[0], curve, j);
+		};
+	} while (isinfinity(T[0]) == 1);	// depends only on randomness
+
+	// Affine Montgomery constant A' = 2(a + d)/(a - d) and x = (Z + Y)/(Z - Y)
+	fp_sub(tmp_0, T[0][1], T[0][0]);
+	fp_mul(w, tmp_0, curve[1]);
+	fp_pow(w, w, inverse);
+	fp_add(tmp_1, a, d);
+	fp_add(tmp_1, tmp_1, tmp_1);
+	fp_mul(tmp_1, tmp_1, tmp_0);
+	fp_mul(tmp_1, tmp_1, w);			// A'
+	fp_add(x, T[0][1], T[0][0]);
+	fp_mul(x, x, curve[1]);
+	fp_mul(x, x, w);				// x
+
+	// (x, y) in Tate normal form: the tangent line at (x, y) is y = 0 after the change of variables
+	fp_add(tmp_2, x, tmp_1);
+	fp_mul(tmp_2, tmp_2, x);
+	fp_add(y, tmp_2, R_mod_p);
+	fp_mul(y, y, x);				// x^3 + A'x^2 + x
+	fp_pow(w, y, inverse_square_root);		// 1/y
+	fp_mul(y, y, w);				// y
+
+	fp_add(tmp_0, tmp_2, tmp_2);
+	fp_sqr(tmp_2, x);
+	fp_add(tmp_0, tmp_0, tmp_2);
+	fp_add(tmp_0, tmp_0, R_mod_p);			// 3x^2 + 2A'x + 1
+	fp_mul(tmp_0, tmp_0, w);			// a1 = (3x^2 + 2A'x + 1)/y
+	if (L[i] == 3)
+	{
+		copy(s[0], tmp_0, NUMBER_OF_WORDS);
+		fp_add(s[1], y, y);			// a3 = 2y
+		FP_ADD_COMPUTED += 1;
+	}
+	else
+	{
+		// b = -a2^3 / a3^2, with (a1, a2, a3) scaled by (2, 4, 8): 4a2 = 4(3x + A') - a1^2 and 8a3 = 16y
+		fp_sqr(tmp_0, tmp_0);
+		fp_add(tmp_2, x, x);
+		fp_add(tmp_2, tmp_2, x);
+		fp_add(tmp_2, tmp_2, tmp_1);
+		fp_add(tmp_2, tmp_2, tmp_2);
+		fp_add(tmp_2, tmp_2, tmp_2);
+		fp_sub(tmp_2, tmp_2, tmp_0);
+		fp_sqr(s[0], tmp_2);
+		fp_mul(s[0], s[0], tmp_2);
+		set_zero(tmp_0, NUMBER_OF_WORDS);
+		fp_sub(s[0], tmp_0, s[0]);		// N = -(4a2)^3
+		fp_integer(tmp_0, 256);
+		fp_sqr(s[1], y);
+		fp_mul(s[1], s[1], tmp_0);		// D = (16y)^2
+		FP_ADD_COMPUTED += 7;
+		FP_SQR_COMPUTED += 3;
+		FP_MUL_COMPUTED += 2;
+	};
+	FP_ADD_COMPUTED += 11;
+	FP_SQR_COMPUTED += 1;
+	FP_MUL_COMPUTED += 9;
+
+	// The chain: bound steps, of which the first e are kept
+	TRACE_BEGIN(TRACE_ISOGENY, i);
+	for (k = 0; k < bound; k++)
+	{
+		if (L[i] == 3)
+			radical_step_3(t, (const fp *)s, root);
+		else
+			radical_step_5(t, (const fp *)s, root);
+
+		j = (uint8_t)(issmaller((int32_t)k, (int32_t)e) & 0x1);	// constant-time k < e
+		fp_cswap(s[0], t[0], j);
+		fp_cswap(s[1], t[1], j);
+	};
+	TRACE_END(TRACE_ISOGENY);
+
+	// Weierstrass invariants of (a1, a2, a3, 0, 0): (a1, 0, a3) for l = 3, and (D - N, -ND, -ND^2) for l = 5
+	if (L[i] == 3)
+	{
+		copy(t[0], s[0], NUMBER_OF_WORDS);			// a1
+		set_zero(tmp_2, NUMBER_OF_WORDS);			// a2
+		copy(t[1], s[1], NUMBER_OF_WORDS);			// a3
+	}
+	else
+	{
+		fp_sub(t[0], s[1], s[0]);
+		fp_mul(tmp_2, s[0], s[1]);
+		set_zero(x, NUMBER_OF_WORDS);
+		fp_sub(tmp_2, x, tmp_2);
+		fp_mul(t[1], tmp_2, s[1]);
+		FP_ADD_COMPUTED += 2;
+		FP_MUL_COMPUTED += 2;
+	};
+	fp_sqr(tmp_0, t[0]);
+	fp_add(tmp_2, tmp_2, tmp_2);
+	fp_add(tmp_2, tmp_2, tmp_2);
+	fp_add(tmp_0, tmp_0, tmp_2);			// b2 = a1^2 + 4a2
+	fp_mul(tmp_1, t[0], t[1]);			// b4 = a1a3
+	fp_sqr(t[1], t[1]);				// b6 = a3^2
+
+	fp_sqr(tmp_2, tmp_0);				// b2^2
+	fp_integer(w, 24);
+	fp_mul(x, tmp_1, w);
+	fp_sub(s[0], tmp_2, x);				// c4 = b2^2 - 24b4
+	fp_integer(w, 36);
+	fp_mul(x, tmp_1, w);
+	fp_sub(x, x, tmp_2);
+	fp_mul(x, x, tmp_0);				// b2(36b4 - b2^2)
+	fp_integer(w, 216);
+	fp_mul(t[1], t[1], w);
+	fp_sub(s[1], x, t[1]);				// c6 = -b2^3 + 36b2b4 - 216b6
+
+	// y^2 = x^3 - 27c4 x - 54c6 has only one root in F_p, 3(u + v) with u^3 and v^3 = c6 +- (c6^2 - c4^3)^(1/2)
+	if (L[i] != 3)
+		exponent(root, 2, -1, 3);			// x^(1/3)
+	fp_sqr(tmp_0, s[0]);
+	fp_mul(tmp_0, tmp_0, s[0]);
+	fp_sqr(tmp_1, s[1]);
+	fp_sub(tmp_0, tmp_1, tmp_0);
+	fp_pow(tmp_0, tmp_0, square_root);		// (c6^2 - c4^3)^(1/2)
+	fp_add(tmp_1, s[1], tmp_0);
+	fp_pow(tmp_1, tmp_1, root);			// u
+	fp_sub(tmp_2, s[1], tmp_0);
+	fp_pow(tmp_2, tmp_2, root);			// v
+	fp_add(tmp_1, tmp_1, tmp_2);			// the root is 3(u + v)
+
+	// Montgomery constant 3(3(u + v))s, where s^2 = 1/(3(3(u + v))^2 - 27c4) and s is a square
+	fp_sqr(tmp_0, tmp_1);
+	fp_sub(tmp_0, tmp_0, s[0]);
+	fp_integer(w, 27);
+	fp_mul(tmp_0, tmp_0, w);
+	fp_pow(tmp_0, tmp_0, inverse_square_root);
+	fp_integer(w, 9);
+	fp_mul(tmp_1, tmp_1, w);
+	fp_mul(tmp_1, tmp_1, tmp_0);			// A'
+
+	// Back to the Edwards curve: a and d are proportional to A' + 2 and A' - 2
+	fp_add(a, R_mod_p, R_mod_p);
+	fp_sub(d, tmp_1, a);
+	fp_add(a, tmp_1, a);
+	fp_cswap(a, d, positive ^ 1);
+	copy(C[0], a, NUMBER_OF_WORDS);
+	fp_sub(C[1], a, d);
+
+	FP_ADD_COMPUTED += 15;
+	FP_SQR_COMPUTED += 6;
+	FP_MUL_COMPUTED += 9;
+};// Cost : (bound + 7 or 8) exponentiations, the search of the point of order L[i], and O(1) operations
@@ -1,18 +1,258 @@
 
 #include "rng.h"
 
+#include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sys/random.h>
 
-void randombytes(void *x, size_t l)
+/*
+ * randombytes() is a ChaCha20 stream generator with fast key erasure: each refill
+ * produces RNG_BLOCKS keystream blocks, the first 32 bytes become the next key and
+ * the remaining ones are handed out (and wiped) by the following calls. Every thread
+ * owns a generator, keyed from the operating system on its first call and again in
+ * the child after a fork(). randombytes_seed() switches all the generators to a
+ * deterministic mode, which is only meant for reproducible benchmarks: the calling
+ * thread takes the stream 0 at once, and any other thread the next stream at its
+ * first call. Thus only the calling thread's outputs are reproducible, unless the
+ * other threads always make their first calls in the same order.
+ */
+
+#define RNG_BLOCKS 16
+#define RNG_BUFFER (64 * RNG_BLOCKS)
+
+typedef struct {
+    uint32_t key[8];
+    uint64_t nonce;             // stream identifier (deterministic mode only)
+    uint64_t counter;           // block counter
+    uint64_t generation;        // value of rng_generation when the key was set
+    size_t available;           // unused bytes at the end of buffer[]
+    uint8_t buffer[RNG_BUFFER];
+} rng_state;
+
+static __thread rng_state state;
+static __thread int state_registered = 0;
+
+static pthread_once_t rng_once = PTHREAD_ONCE_INIT;
+static pthread_key_t rng_key;
+static pthread_mutex_t rng_lock = PTHREAD_MUTEX_INITIALIZER;
+static int fd = -1;
+
+static volatile uint64_t rng_generation = 1;    // bumped by fork() and by randombytes_seed()
+static int rng_seeded = 0;                      // deterministic mode (protected by rng_lock)
+static uint8_t rng_seed[32];
+static uint64_t rng_streams = 0;                // next stream identifier (protected by rng_lock)
+
+#define ROTL32(x, n) (((x) << (n)) | ((x) >> (32 - (n))))
+#define QUARTERROUND(a, b, c, d) \
+    a += b; d ^= a; d = ROTL32(d, 16); \
+    c += d; b ^= c; b = ROTL32(b, 12); \
+    a += b; d ^= a; d = ROTL32(d, 8); \
+    c += d; b ^= c; b = ROTL32(b, 7);
+
+static void chacha20_block(uint8_t out[64], const uint32_t key[8], uint64_t counter, uint64_t nonce)
+{
+    uint32_t x[16], j[16];
+    int i;
+
+    j[0] = 0x61707865; j[1] = 0x3320646e; j[2] = 0x79622d32; j[3] = 0x6b206574;
+    for (i = 0; i < 8; ++i)
+        j[4 + i] = key[i];
+    j[12] = (uint32_t)counter; j[13] = (uint32_t)(counter >> 32);
+    j[14] = (uint32_t)nonce;   j[15] = (uint32_t)(nonce >> 32);
+
+    memcpy(x, j, sizeof(x));
+    for (i = 0; i < 10; ++i) {
+        QUARTERROUND(x[0], x[4], x[ 8], x[12])
+        QUARTERROUND(x[1], x[5], x[ 9], x[13])
+        QUARTERROUND(x[2], x[6], x[10], x[14])
+        QUARTERROUND(x[3], x[7], x[11], x[15])
+        QUARTERROUND(x[0], x[5], x[10], x[15])
+        QUARTERROUND(x[1], x[6], x[11], x[12])
+        QUARTERROUND(x[2], x[7], x[ 8], x[13])
+        QUARTERROUND(x[3], x[4], x[ 9], x[14])
+    }
+    for (i = 0; i < 16; ++i) {
+        x[i] += j[i];
+        out[4 * i + 0] = (uint8_t)(x[i]);
+        out[4 * i + 1] = (uint8_t)(x[i] >> 8);
+        out[4 * i + 2] = (uint8_t)(x[i] >> 16);
+        out[4 * i + 3] = (uint8_t)(x[i] >> 24);
+    }
+    explicit_bzero(x, sizeof(x));
+    explicit_bzero(j, sizeof(j));
+}
+
+static void rng_atfork_prepare(void)
+{
+    pthread_mutex_lock(&rng_lock);
+}
+
+static void rng_atfork_parent(void)
+{
+    pthread_mutex_unlock(&rng_lock);
+}
+
+static void rng_atfork_child(void)
+{
+    rng_generation += 1;    // forces every generator of the child to be rekeyed
+    pthread_mutex_unlock(&rng_lock);
+}
+
+static void rng_wipe(void *s)
+{
+    explicit_bzero(s, sizeof(rng_state));
+}
+
+static void rng_init(void)
+{
+    pthread_key_create(&rng_key, rng_wipe);
+    pthread_atfork(rng_atfork_prepare, rng_atfork_parent, rng_atfork_child);
+}
+
+static void urandom(void *x, size_t l)
 {
-    static int fd = -1;
     ssize_t n;
-    if (fd < 0 && 0 > (fd = open("/dev/urandom", O_RDONLY)))
-        exit(1);
-    for (size_t i = 0; i < l; i += n)
-        if (0 >= (n = read(fd, (char *) x + i, l - i)))
-            exit(2);
+    for (size_t i = 0; i < l; i += n) {
+        n = getrandom((char *) x + i, l - i, 0);
+        if (n < 0 && errno == EINTR) {
+            n = 0;
+            continue;
+        }
+        if (n < 0) {
+            // No getrandom() syscall: fall back to the device (opened once for all the threads)
+            pthread_mutex_lock(&rng_lock);
+            if (fd < 0 && 0 > (fd = open("/dev/urandom", O_RDONLY | O_CLOEXEC))) {
+                pthread_mutex_unlock(&rng_lock);
+                exit(1);
+            }
+            pthread_mutex_unlock(&rng_lock);
+            if (0 >= (n = read(fd, (char *) x + i, l - i)))
+                exit(2);
+        }
+    }
 }
 
+// Sets the key and the stream of a generator, and drops its buffered bytes
+static void rng_load(rng_state *s, const uint8_t k[32], uint64_t nonce)
+{
+    for (int i = 0; i < 8; ++i)
+        s->key[i] = (uint32_t)k[4 * i] | ((uint32_t)k[4 * i + 1] << 8) | ((uint32_t)k[4 * i + 2] << 16) | ((uint32_t)k[4 * i + 3] << 24);
+    s->nonce = nonce;
+    s->counter = 0;
+    explicit_bzero(s->buffer, sizeof(s->buffer));
+    s->available = 0;
+}
+
+static void rng_rekey(rng_state *s)
+{
+    uint8_t k[32];
+    uint64_t nonce = 0;
+    int seeded;
+
+    pthread_mutex_lock(&rng_lock);
+    s->generation = rng_generation;
+    seeded = rng_seeded;
+    if (seeded) {
+        memcpy(k, rng_seed, sizeof(k));
+        nonce = rng_streams++;
+    }
+    pthread_mutex_unlock(&rng_lock);
+
+    if (!seeded)
+        urandom(k, sizeof(k));
+    rng_load(s, k, nonce);
+    explicit_bzero(k, sizeof(k));
+}
+
+static void rng_refill(rng_state *s)
+{
+    for (int i = 0; i < RNG_BLOCKS; ++i)
+        chacha20_block(s->buffer + 64 * i, s->key, s->counter++, s->nonce);
+
+    // Fast key erasure: the first 32 bytes replace the key, thus past outputs cannot be recomputed
+    for (int i = 0; i < 8; ++i)
+        s->key[i] = (uint32_t)s->buffer[4 * i] | ((uint32_t)s->buffer[4 * i + 1] << 8) | ((uint32_t)s->buffer[4 * i + 2] << 16) | ((uint32_t)s->buffer[4 * i + 3] << 24);
+    explicit_bzero(s->buffer, 32);
+    s->available = RNG_BUFFER - 32;
+}
+
+static void rng_register(rng_state *s)
+{
+    if (!state_registered) {
+        pthread_once(&rng_once, rng_init);
+        pthread_setspecific(rng_key, s);    // the state is wiped when the thread exits
+        state_registered = 1;
+    }
+}
+
+void randombytes_seed(const uint8_t seed[32])
+{
+    rng_state *s = &state;
+
+    rng_register(s);
+    pthread_mutex_lock(&rng_lock);
+    memcpy(rng_seed, seed, sizeof(rng_seed));
+    rng_seeded = 1;
+    rng_generation += 1;
+    // The calling thread owns the stream 0 whichever thread draws first
+    s->generation = rng_generation;
+    rng_load(s, rng_seed, 0);
+    rng_streams = 1;
+    pthread_mutex_unlock(&rng_lock);
+}
+
+void randombytes(void *x, size_t l)
+{
+    rng_state *s = &state;
+    uint8_t *out = (uint8_t *) x;
+    size_t n;
+
+    rng_register(s);
+    if (s->generation != rng_generation)
+        rng_rekey(s);
+
+    while (l > 0) {
+        if (s->available == 0)
+            rng_refill(s);
+        n = (l < s->available) ? l : s->available;
+        memcpy(out, s->buffer + RNG_BUFFER - s->available, n);
+        explicit_bzero(s->buffer + RNG_BUFFER - s->available, n);
+        s->available -= n;
+        out += n;
+        l -= n;
+    }
+}
+
+/*
+ * Known answer of chacha20_block(): the keystream of the all-zero key and nonce
+ * (blocks 0 and 1, test vector #1 of RFC 7539, section A.1, with the 64-bit nonce
+ * and counter of the original ChaCha20).
+ */
+static const uint8_t chacha20_zero_keystream[128] = {
+    0x76, 0xb8, 0xe0, 0xad, 0xa0, 0xf1, 0x3d, 0x90, 0x40, 0x5d, 0x6a, 0xe5, 0x53, 0x86, 0xbd, 0x28,
+    0xbd, 0xd2, 0x19, 0xb8, 0xa0, 0x8d, 0xed, 0x1a, 0xa8, 0x36, 0xef, 0xcc, 0x8b, 0x77, 0x0d, 0xc7,
+    0xda, 0x41, 0x59, 0x7c, 0x51, 0x57, 0x48, 0x8d, 0x77, 0x24, 0xe0, 0x3f, 0xb8, 0xd8, 0x4a, 0x37,
+    0x6a, 0x43, 0xb8, 0xf4, 0x15, 0x18, 0xa1, 0x1c, 0xc3, 0x87, 0xb6, 0x69, 0xb2, 0xee, 0x65, 0x86,
+    0x9f, 0x07, 0xe7, 0xbe, 0x55, 0x51, 0x38, 0x7a, 0x98, 0xba, 0x97, 0x7c, 0x73, 0x2d, 0x08, 0x0d,
+    0xcb, 0x0f, 0x29, 0xa0, 0x48, 0xe3, 0x65, 0x69, 0x12, 0xc6, 0x53, 0x3e, 0x32, 0xee, 0x7a, 0xed,
+    0x29, 0xb7, 0x21, 0x76, 0x9c, 0xe6, 0x4e, 0x43, 0xd5, 0x71, 0x33, 0xb0, 0x74, 0xd8, 0x39, 0xd5,
+    0x31, 0xed, 0x1f, 0x28, 0x51, 0x0a, 0xfb, 0x45, 0xac, 0xe1, 0x0a, 0x1f, 0x4b, 0x79, 0x4d, 0x6f
+};
+
+int randombytes_selftest(void)
+{
+    const uint32_t key[8] = {0};
+    uint8_t block[64];
+    int diff = 0;
+
+    for (uint64_t counter = 0; counter < 2; ++counter) {
+        chacha20_block(block, key, counter, 0);
+        diff |= memcmp(block, chacha20_zero_keystream + 64 * counter, sizeof(block));
+    }
+    return (diff != 0) ? -1 : 0;
+}
@@ -0,0 +1,210 @@
+#ifdef ACTION_TRACE
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <x86intrin.h>
+
+#include "trace.h"
+
+#define TRACE_DEPTH 8
+
+static const char *PHASE_NAMES[TRACE_PHASES] = {
+	"action", "round", "elligator", "cofactor", "kernel", "isogeny", "evaluation", "wasted"
+};
+
+typedef struct {
+	uint64_t start, end;
+	uint32_t arg;
+	uint8_t phase;
+} trace_event;
+
+// Events of one thread: only its owner appends to it, thus recording never locks
+typedef struct trace_buffer {
+	trace_event *events;
+	size_t count, capacity;
+	size_t open[TRACE_DEPTH];	// events begun and not ended yet
+	uint8_t depth;
+	uint32_t tid;
+	struct trace_buffer *next;
+} trace_buffer;
+
+static pthread_mutex_t trace_lock = PTHREAD_MUTEX_INITIALIZER;
+static trace_buffer *buffers = NULL;
+static uint32_t threads = 0;
+static __thread trace_buffer *buffer = NULL;
+
+static trace_buffer *thread_buffer(void)
+{
+	if (buffer == NULL)
+	{
+		buffer = calloc(1, sizeof(trace_buffer));
+		if (buffer == NULL)
+			exit(1);
+		pthread_mutex_lock(&trace_lock);
+		buffer->tid = threads++;
+		buffer->next = buffers;
+		buffers = buffer;
+		pthread_mutex_unlock(&trace_lock);
+	};
+	return buffer;
+};
+
+void trace_begin(uint8_t phase, uint32_t arg)
+{
+	trace_buffer *b = thread_buffer();
+
+	if (b->count == b->capacity)
+	{
+		b->capacity = (b->capacity > 0) ? 2 * b->capacity : 4096;
+		b->events = realloc(b->events, b->capacity * sizeof(trace_event));
+		if (b->events == NULL)
+			exit(1);
+	};
+	if (b->depth < TRACE_DEPTH)
+		b->open[b->depth] = b->count;
+	b->depth += 1;
+	b->events[b->count].phase = phase;
+	b->events[b->count].arg = arg;
+	b->events[b->count].end = 0;
+	b->count += 1;
+	b->events[b->count - 1].start = __rdtsc();
+};
+
+// The innermost open event, if it is of this phase, ends at end
+static trace_event *trace_close(uint8_t phase, uint64_t end)
+{
+	trace_buffer *b = thread_buffer();
+	trace_event *e;
+
+	if (b->depth == 0)
+		return NULL;
+	b->depth -= 1;
+	if (b->depth >= TRACE_DEPTH)
+		return NULL;
+	e = &b->events[b->open[b->depth]];
+	if (e->phase != phase)
+		return NULL;	// unbalanced instrumentation: the event is left open
+	e->end = end;
+	return e;
+};
+
+void trace_end(uint8_t phase, uint32_t arg)
+{
+	trace_event *e = trace_close(phase, __rdtsc());
+
+	if ((e != NULL) && (arg != UINT32_MAX))
+		e->arg = arg;
+};
+
+void trace_end_as(uint8_t phase, uint8_t as)
+{
+	trace_event *e = trace_close(phase, __rdtsc());
+
+	if (e != NULL)
+		e->phase = as;
+};
+
+// Drops every recorded event (no action may be running)
+void trace_reset(void)
+{
+	pthread_mutex_lock(&trace_lock);
+	for (trace_buffer *b = buffers; b != NULL; b = b->next)
+	{
+		b->count = 0;
+		b->depth = 0;
+	};
+	pthread_mutex_unlock(&trace_lock);
+};
+
+// Counter ticks per microsecond, measured against the monotonic clock
+static double ticks_per_us(void)
+{
+	struct timespec t0, t1;
+	uint64_t c0, c1;
+	double ns;
+
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+	c0 = __rdtsc();
+	do {
+		clock_gettime(CLOCK_MONOTONIC, &t1);
+		ns = 1e9 * (double)(t1.tv_sec - t0.tv_sec) + (double)(t1.tv_nsec - t0.tv_nsec);
+	} while (ns < 2e7);
+	c1 = __rdtsc();
+	return (double)(c1 - c0) / (ns / 1000.0);
+};
+
+/* ----------------------------------------------------------------------------------------------- *
+   trace_dump()
+   input: the path of the output file;
+   output: 0 if the events of all the threads were written in the Chrome trace format, -1 otherwise.
+           Timestamps are in microseconds since the first event, and each event has its cycles as
+           argument.
+ * ----------------------------------------------------------------------------------------------- */
+int trace_dump(const char *path)
+{
+	FILE *out = fopen(path, "w");
+	uint64_t origin = UINT64_MAX;
+	double scale = ticks_per_us();
+	int first = 1;
+
+	if (out == NULL)
+		return -1;
+
+	pthread_mutex_lock(&trace_lock);
+	for (trace_buffer *b = buffers; b != NULL; b = b->next)
+		for (size_t i = 0; i < b->count; i++)
+			if (b->events[i].start < origin)
+				origin = b->events[i].start;
+
+	fprintf(out, "{\"displayTimeUnit\": \"ns\", \"otherData\": {\"cycles_per_us\": %.1f},\n\"traceEvents\": [\n", scale);
+	for (trace_buffer *b = buffers; b != NULL; b = b->next)
+	{
+		for (size_t i = 0; i < b->count; i++)
+		{
+			const trace_event *e = &b->events[i];
+			if (e->end == 0)
+				continue;
+			fprintf(out, "%s{\"name\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": %u, \"ts\": %.3f, \"dur\": %.3f, "
+			             "\"args\": {\"cycles\": %lu, \"arg\": %u}}",
+			        first ? "" : ",\n", PHASE_NAMES[e->phase], b->tid, (double)(e->start - origin) / scale,
+			        (double)(e->end - e->start) / scale, e->end - e->start, e->arg);
+			first = 0;
+		};
+	};
+	fprintf(out, "\n]}\n");
+	pthread_mutex_unlock(&trace_lock);
+	return (fclose(out) == 0) ? 0 : -1;
+};
+
+// Total cycles and number of events of each phase, and number of rounds per action
+void trace_summary(FILE *out)
+{
+	uint64_t cycles[TRACE_PHASES] = {0}, events[TRACE_PHASES] = {0}, rounds = 0;
+
+	pthread_mutex_lock(&trace_lock);
+	for (trace_buffer *b = buffers; b != NULL; b = b->next)
+	{
+		for (size_t i = 0; i < b->count; i++)
+		{
+			const trace_event *e = &b->events[i];
+			if (e->end == 0)
+				continue;
+			cycles[e->phase] += e->end - e->start;
+			events[e->phase] += 1;
+			if (e->phase == TRACE_ACTION)
+				rounds += e->arg;
+		};
+	};
+	pthread_mutex_unlock(&trace_lock);
+
+	fprintf(out, "%-12s %10s %16s %8s\n", "phase", "events", "cycles", "share");
+	for (int p = 0; p < TRACE_PHASES; p++)
+		fprintf(out, "%-12s %10lu %16lu %7.2f%%\n", PHASE_NAMES[p], events[p], cycles[p],
+		        (cycles[TRACE_ACTION] > 0) ? 100.0 * (double)cycles[p] / (double)cycles[TRACE_ACTION] : 0);
+	if (events[TRACE_ACTION] > 0)
+		fprintf(out, "rounds per action: %.2f\n", (double)rounds / (double)events[TRACE_ACTION]);
+};
+
+#endif
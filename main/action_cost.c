@@ -1,16 +1,16 @@
+#include <getopt.h>
 #include <math.h>
-#include<time.h>
+#include <unistd.h>
 
 #include "fp.h"
 #include "edwards_curve.h"
+#include "bench.h"
 
-// Measuring the perfomance
-static uint64_t get_cycles()
-{
-   uint32_t lo, hi;
-   asm volatile("rdtsc":"=a"(lo),"=d"(hi));
-   return ((uint64_t)hi<<32) | lo;
-};
+// Number of field operations of the action. They only depend on the keys and on the sampled points,
+// thus with a fixed seed they are reproducible and can be compared against a committed baseline.
+#define OPERATIONS 3
+
+static const char *OPERATION_NAMES[OPERATIONS] = { "additions", "squarings", "multiplications" };
 
 static uint8_t csidh(proj out, const uint8_t sk[], const proj in)
 {
@@ -25,112 +25,176 @@ static uint8_t csidh(proj out, const uint8_t sk[], const proj in)
 	return 1;
 };
 
-unsigned long its = 1024;
+/* ----------------------------------------------------------------------------------------------- *
+   compare_baseline()
+   inputs: a baseline written by action_cost -f csv, the summaries of the current build, and the
+           tolerance in percent;
+   output: the number of operations whose mean or 99th percentile exceeds the baseline by more than
+           the tolerance (-1 if the baseline cannot be used).
+ * ----------------------------------------------------------------------------------------------- */
+static int compare_baseline(const char *path, const bench_summary summary[], double tolerance)
+{
+	char line[256], name[32];
+	size_t count;
+	double mean, stddev;
+	uint64_t min, median, p90, p99, max;
+	int regressions = 0, found = 0;
+	FILE *in = fopen(path, "r");
+
+	if (in == NULL)
+	{
+		perror(path);
+		return -1;
+	};
+	while (fgets(line, sizeof(line), in) != NULL)
+	{
+		if (sscanf(line, "%31[^,],%zu,%lf,%lf,%lu,%lu,%lu,%lu,%lu", name, &count, &mean, &stddev, &min, &median,
+		           &p90, &p99, &max) != 9)
+			continue;	// header
+
+		for (int j = 0; j < OPERATIONS; j++)
+		{
+			if (strcmp(name, OPERATION_NAMES[j]) != 0)
+				continue;
+			found += 1;
+			if (count != summary[j].count)
+			{
+				fprintf(stderr, "%s: baseline of %zu iterations, not %zu\n", path, count, summary[j].count);
+				fclose(in);
+				return -1;
+			};
+
+			double mean_change = 100.0 * (summary[j].mean - mean) / mean;
+			double p99_change = 100.0 * ((double)summary[j].p99 - (double)p99) / (double)p99;
+			// The baseline mean is rounded to one decimal, hence the slack of 0.1
+			int regressed = (summary[j].mean - mean > 0.1 + tolerance * mean / 100.0) || (p99_change > tolerance);
+
+			fprintf(stderr, "%-16s mean %14.1f (%+.3f%%)   p99 %12lu (%+.3f%%)   %s\n", name, summary[j].mean,
+			        mean_change, summary[j].p99, p99_change, regressed ? "REGRESSION" : "ok");
+			regressions += regressed;
+			if (!regressed && ((mean_change < -tolerance) || (p99_change < -tolerance)))
+				fprintf(stderr, "%-16s improved beyond the tolerance: consider updating %s\n", name, path);
+		};
+	};
+	fclose(in);
+	if (found != OPERATIONS)
+	{
+		fprintf(stderr, "%s: missing operations\n", path);
+		return -1;
+	};
+	return regressions;
+};
 
-int main()
+static void usage(void)
 {
-	unsigned int i;
+	fprintf(stderr, "usage: action_cost [-n iterations] [-f text|json|csv] [-s seed] [-b baseline.csv [-t tolerance]] [seed]\n");
+	fprintf(stderr, "  -n: number of actions (default: 1024)\n");
+	fprintf(stderr, "  -f: output format (default: text); -f csv writes a baseline\n");
+	fprintf(stderr, "  -s: seed (any string of at most 32 bytes) making the random keys and points reproducible\n");
+	fprintf(stderr, "  -b: compare the mean and 99th percentile of the operations against a baseline, and\n");
+	fprintf(stderr, "      exit with status 2 if any exceeds it by more than the tolerance\n");
+	fprintf(stderr, "  -t: tolerance in percent (default: 0)\n");
+};
 
-	uint64_t add_min = 0xFFFFFFFFFFFFFFFF, add_max = 0, 
-	         sqr_min = 0xFFFFFFFFFFFFFFFF, sqr_max = 0, 
-	         mul_min = 0xFFFFFFFFFFFFFFFF, mul_max = 0;
+int main(int argc, char **argv)
+{
+	size_t its = 1024, i;
+	int option, j;
+	double tolerance = 0;
+	bench_format format = BENCH_TEXT;
+	char *seed_str = NULL, *baseline = NULL;
 
-	float add_mean = 0, add_variance = 0,
-	      sqr_mean = 0, sqr_variance = 0,
-	      mul_mean = 0, mul_variance = 0;
+	while ((option = getopt(argc, argv, "hn:f:s:b:t:")) != -1)
+	{
+		switch (option)
+		{
+			case 'n':
+				its = strtoul(optarg, NULL, 10);
+				break;
+			case 'f':
+				if (bench_parse_format(optarg, &format) != 0)
+				{
+					usage();
+					return 1;
+				};
+				break;
+			case 's':
+				seed_str = optarg;
+				break;
+			case 'b':
+				baseline = optarg;
+				break;
+			case 't':
+				tolerance = atof(optarg);
+				break;
+			case 'h':
+			default:
+				usage();
+				return (option == 'h') ? 0 : 1;
+		};
+	};
+	// The seed used to be the only (positional) argument
+	if ((seed_str == NULL) && (optind < argc))
+		seed_str = argv[optind];
+	if (seed_str != NULL)
+	{
+		uint8_t seed[32] = {0};
+		memcpy(seed, seed_str, strnlen(seed_str, sizeof(seed)));
+		randombytes_seed(seed);
+	};
 
-	uint64_t add_sample[its],
-	         sqr_sample[its],
-	         mul_sample[its];
+	bench_samples samples[OPERATIONS];
+	for (j = 0; j < OPERATIONS; j++)
+	{
+		if ((its == 0) || (bench_samples_init(&samples[j], OPERATION_NAMES[j], its) != 0))
+		{
+			usage();
+			return 1;
+		};
+	};
 
 	// ---
 	uint8_t key[N];
 	proj random_E;
 	point_copy(random_E, E);
 
-	for(i = 0; i < its; ++i)
+	for (i = 0; i < its; ++i)
 	{
-
-		if (its >= 100 && i % (its / 100) == 0) {
-			printf("Doing %lu iterations of action with validation key:\t", its);
-            printf("%2lu%%", 100 * i / its);
-            fflush(stdout);
-            printf("\r\x1b[K");
-        }
+		if (isatty(fileno(stderr)) && (its >= 100) && (i % (its / 100) == 0))
+		{
+			fprintf(stderr, "\r\x1b[KDoing %zu iterations of action with validation key: %2zu%%", its, 100 * i / its);
+			fflush(stderr);
+		};
 
 		random_key(key);
 		assert(csidh(random_E, key, random_E));
-		
-		// ---
-		add_sample[i] = FP_ADD_COMPUTED;
-		sqr_sample[i] = FP_SQR_COMPUTED;
-		mul_sample[i] = FP_MUL_COMPUTED;
-
-		/**************************************/
-		if(add_min > add_sample[i])
-			add_min = add_sample[i];
-		if(sqr_min > sqr_sample[i])
-			sqr_min = sqr_sample[i];
-		if(mul_min > mul_sample[i])
-			mul_min = mul_sample[i];
-
-		/**************************************/
-		if(add_max < add_sample[i])
-			add_max = add_sample[i];
-		if(sqr_max < sqr_sample[i])
-			sqr_max = sqr_sample[i];
-		if(mul_max < mul_sample[i])
-			mul_max = mul_sample[i];
-		
-		/**************************************/
-		add_mean += (float)add_sample[i];
-		sqr_mean += (float)sqr_sample[i];
-		mul_mean += (float)mul_sample[i];
-	};
 
+		bench_samples_add(&samples[0], FP_ADD_COMPUTED);
+		bench_samples_add(&samples[1], FP_SQR_COMPUTED);
+		bench_samples_add(&samples[2], FP_MUL_COMPUTED);
+	};
+	if (isatty(fileno(stderr)))
+		fprintf(stderr, "\r\x1b[K");
 
-	add_mean = add_mean / ((float)its * 1.0);
-	sqr_mean = sqr_mean / ((float)its * 1.0);
-	mul_mean = mul_mean / ((float)its * 1.0);
+	bench_environment env;
+	bench_summary summary[OPERATIONS];
 
-	for (i = 0; i < its; ++i)
+	bench_environment_init(&env, "action_cost", -1, its, 0);
+	env.unit = "operations";
+	bench_report_begin(stdout, format, &env);
+	for (j = 0; j < OPERATIONS; j++)
 	{
-		add_variance += (add_sample[i] - add_mean)*(add_sample[i] - add_mean);
-		sqr_variance += (sqr_sample[i] - sqr_mean)*(sqr_sample[i] - sqr_mean);
-		mul_variance += (mul_sample[i] - mul_mean)*(mul_sample[i] - mul_mean);
+		bench_summarize(&samples[j], &summary[j]);
+		bench_report(stdout, format, OPERATION_NAMES[j], &summary[j], j == 0);
+		bench_samples_free(&samples[j]);
 	};
+	bench_report_end(stdout, format);
 
-	add_variance = add_variance / ((float)its - 1.0);
-	sqr_variance = sqr_variance / ((float)its - 1.0);
-	mul_variance = mul_variance / ((float)its - 1.0);
-		
-	printf("\x1b[01;33mIterations: %lu\x1b[0m\n\n", its);
-
-	printf("\x1b[33mAverage costs:\x1b[0m\n");
-	printf("\t %f additions,\n", add_mean);
-	printf("\t\x1b[32m %f squarings,\x1b[0m\n", sqr_mean);
-	printf("\t\x1b[31m %f multiplications.\x1b[0m\n", mul_mean);
-
-	printf("\n");
-
-	printf("\x1b[33mStandard deviation of the costs:\x1b[0m\n");
-	printf("\t %f additions,\n", sqrt(add_variance));
-	printf("\t\x1b[32m %f squarings,\x1b[0m\n", sqrt(sqr_variance));
-	printf("\t\x1b[31m %f multiplications.\x1b[0m\n", sqrt(mul_variance));
-
-	printf("\n");
-
-	printf("\x1b[33mMinimum costs:\x1b[0m\n");
-	printf("\t %lu additions,\n", add_min);
-	printf("\t\x1b[32m %lu squarings,\x1b[0m\n", sqr_min);
-	printf("\t\x1b[31m %lu multiplications.\x1b[0m\n", mul_min);
-
-	printf("\n");
-
-	printf("\x1b[33mMaximum costs:\x1b[0m\n");
-	printf("\t %lu additions,\n", add_max);
-	printf("\t\x1b[32m %lu squarings,\x1b[0m\n", sqr_max);
-	printf("\t\x1b[31m %lu multiplications.\x1b[0m\n", mul_max);
-
+	if (baseline != NULL)
+	{
+		int regressions = compare_baseline(baseline, summary, tolerance);
+		if (regressions != 0)
+			return (regressions < 0) ? 1 : 2;
+	};
 	return 0;
 };
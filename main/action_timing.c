@@ -1,95 +1,264 @@
+#include <getopt.h>
 #include <math.h>
-#include<time.h>
+#include <time.h>
+#include <unistd.h>
 
 #include "fp.h"
 #include "edwards_curve.h"
+#include "bench.h"
+#include "parallel.h"
 
-// Measuring the perfomance
-static uint64_t get_cycles()
-{
-   uint32_t lo, hi;
-   asm volatile("rdtsc":"=a"(lo),"=d"(hi));
-   return ((uint64_t)hi<<32) | lo;
-};
+#define PHASE_KEYGEN   0x1	// random_key() and the action on the base curve E
+#define PHASE_VALIDATE 0x2	// validation of a fresh public curve
+#define PHASE_DERIVE   0x4	// validation and action on a fresh public curve
 
-static uint8_t csidh(proj out, const uint8_t sk[], const proj in)
+static uint8_t csidh(proj out, const uint8_t sk[], const proj in, uint32_t threads)
 {
-	FP_ADD_COMPUTED = 0;
-	FP_SQR_COMPUTED = 0;
-	FP_MUL_COMPUTED = 0;
-
-	if (!validate(in)) {
+	if (!validate_parallel(in, threads)) {
 		return 0;
 	};
 	action_evaluation(out, sk, in);
 	return 1;
 };
 
-unsigned long its = 1024;
+static int parse_phases(char *str)
+{
+	int phases = 0;
+	for (char *phase = strtok(str, ","); phase != NULL; phase = strtok(NULL, ","))
+	{
+		if (strcmp(phase, "keygen") == 0)
+			phases |= PHASE_KEYGEN;
+		else if (strcmp(phase, "validate") == 0)
+			phases |= PHASE_VALIDATE;
+		else if (strcmp(phase, "derive") == 0)
+			phases |= PHASE_DERIVE;
+		else
+			return 0;
+	};
+	return phases;
+};
 
-int main()
+static void usage(void)
 {
-	unsigned int i;
+	fprintf(stderr, "usage: action_timing [-n iterations] [-w warm-up] [-c cpu] [-f text|json|csv] [-p phases] [-s seed] [-j threads] [-P [-K counters.csv]] [seed]\n");
+	fprintf(stderr, "  -n: measured iterations of each phase (default: 1024)\n");
+	fprintf(stderr, "  -w: iterations run before measuring (default: 16)\n");
+	fprintf(stderr, "  -c: pin the benchmark to this CPU\n");
+	fprintf(stderr, "  -f: output format (default: text)\n");
+	fprintf(stderr, "  -p: comma-separated list of phases among keygen, validate and derive (default: all)\n");
+	fprintf(stderr, "  -s: seed (any string of at most 32 bytes) making the random keys and points reproducible\n");
+	fprintf(stderr, "  -j: threads of the validation in the validate and derive phases (default: 1)\n");
+	fprintf(stderr, "  -P: also read the hardware performance counters (cycles, instructions, branch and L1D misses)\n");
+	fprintf(stderr, "  -K: with -f csv, the file the counters are written to (default: counters.csv)\n");
+#ifdef ACTION_TRACE
+	fprintf(stderr, "  -t: Chrome trace output file (default: action_trace.json)\n");
+#endif
+};
+
+int main(int argc, char **argv)
+{
+	size_t its = 1024, warmup = 16, i;
+	uint32_t threads = 1;
+	int cpu = -1, phases = PHASE_KEYGEN | PHASE_VALIDATE | PHASE_DERIVE, option, first = 1, perf = 0;
+	bench_format format = BENCH_TEXT;
+	char *seed_str = NULL;
+	char *trace_file = "action_trace.json";
+	char *counters_file = "counters.csv";
+	FILE *counters_out = stdout;
+
+	while ((option = getopt(argc, argv, "hn:w:c:f:p:s:j:t:PK:")) != -1)
+	{
+		switch (option)
+		{
+			case 'n':
+				its = strtoul(optarg, NULL, 10);
+				break;
+			case 'w':
+				warmup = strtoul(optarg, NULL, 10);
+				break;
+			case 'c':
+				cpu = atoi(optarg);
+				break;
+			case 'f':
+				if (bench_parse_format(optarg, &format) != 0)
+				{
+					usage();
+					return 1;
+				};
+				break;
+			case 'p':
+				if ((phases = parse_phases(optarg)) == 0)
+				{
+					usage();
+					return 1;
+				};
+				break;
+			case 's':
+				seed_str = optarg;
+				break;
+			case 'j':
+				threads = strtoul(optarg, NULL, 10);
+				break;
+			case 't':
+				trace_file = optarg;
+				break;
+			case 'P':
+				perf = 1;
+				break;
+			case 'K':
+				counters_file = optarg;
+				break;
+			case 'h':
+			default:
+				usage();
+				return (option == 'h') ? 0 : 1;
+		};
+	};
+	// The seed used to be the only (positional) argument
+	if ((seed_str == NULL) && (optind < argc))
+		seed_str = argv[optind];
+	if (seed_str != NULL)
+	{
+		uint8_t seed[32] = {0};
+		memcpy(seed, seed_str, strnlen(seed_str, sizeof(seed)));
+		randombytes_seed(seed);
+	};
+	if ((cpu >= 0) && (bench_pin(cpu) != 0))
+	{
+		perror("sched_setaffinity");
+		return 1;
+	};
 
-	double cc_min = 0xFFFFFFFFFFFFFFFF, cc_max = 0;
-	double cc_mean = 0, cc_variance = 0;
+	bench_samples keygen, validation, derive;
+	if ((bench_samples_init(&keygen, "keygen", its) != 0) || (bench_samples_init(&validation, "validate", its) != 0) ||
+	    (bench_samples_init(&derive, "derive", its) != 0))
+	{
+		fprintf(stderr, "Unable to allocate %zu samples\n", its);
+		return 1;
+	};
 
-	double cc_sample[its], cc_0, cc_1;
+	// The counters are read around the same code as the cycles, thus their reads are measured too
+	// (a few thousand cycles per phase, negligible against an action)
+	bench_counters counters;
+	bench_counts counts[3] = {0};
+	if (perf && (bench_counters_open(&counters) == 0))
+	{
+		fprintf(stderr, "Hardware performance counters unavailable (see /proc/sys/kernel/perf_event_paranoid)\n");
+		bench_counters_close(&counters);
+		perf = 0;
+	};
+	// In CSV, the counters are a table of their own
+	if (perf && (format == BENCH_CSV) && ((counters_out = fopen(counters_file, "w")) == NULL))
+	{
+		perror(counters_file);
+		return 1;
+	};
 
 	// ---
 	uint8_t key[N];
-	proj random_E;
-
-	point_copy(random_E, E);
+	proj public_curve, shared_curve;
+	uint64_t cc_0, cc_1;
 
-	for(i = 0; i < its; ++i)
+	for (i = 0; i < warmup + its; ++i)
 	{
+		if ((format == BENCH_TEXT) && isatty(fileno(stderr)) && (its >= 100) && (i >= warmup) && ((i - warmup) % (its / 100) == 0))
+		{
+			fprintf(stderr, "\r\x1b[KDoing %zu iterations: %2zu%%", its, 100 * (i - warmup) / its);
+			fflush(stderr);
+		};
 
-		if (its >= 100 && i % (its / 100) == 0) {
-			printf("Doing %lu iterations of action with validation key:\t", its);
-            printf("%2lu%%", 100 * i / its);
-            fflush(stdout);
-            printf("\r\x1b[K");
-        }
-
+#ifdef ACTION_TRACE
+		if (i == warmup)
+			trace_reset();	// the warm-up is not traced
+#endif
+		// A fresh public curve: it is the input of the next phases even if keygen is not measured
 		random_key(key);
-		cc_0 = get_cycles();
-		assert(csidh(random_E, key, random_E));
-		cc_1 = get_cycles();
-		
-		cc_sample[i] = (double)(cc_1 - cc_0) / (1000000.0) ;
-		// ---
-
-
-		/**************************************/
-		if(cc_min > cc_sample[i])
-			cc_min = cc_sample[i];
-
-		/**************************************/
-		if(cc_max < cc_sample[i])
-			cc_max = cc_sample[i];
-		
-		/**************************************/
-		cc_mean += (double)cc_sample[i];
-	};
+		if (perf)
+			bench_counters_start(&counters);
+		cc_0 = bench_start();
+		action_evaluation(public_curve, key, E);
+		cc_1 = bench_stop();
+		if ((i >= warmup) && (phases & PHASE_KEYGEN))
+		{
+			if (perf)
+				bench_counters_stop(&counters, &counts[0]);
+			bench_samples_add(&keygen, cc_1 - cc_0);
+		};
 
+		if (phases & PHASE_VALIDATE)
+		{
+			if (perf)
+				bench_counters_start(&counters);
+			cc_0 = bench_start();
+			uint8_t valid = validate_parallel(public_curve, threads);
+			cc_1 = bench_stop();
+			if (perf && (i >= warmup))
+				bench_counters_stop(&counters, &counts[1]);
+			assert(valid);
+			if (i >= warmup)
+				bench_samples_add(&validation, cc_1 - cc_0);
+		};
 
-	cc_mean = cc_mean / ((double)its * 1.0);
-
-	for (i = 0; i < its; ++i)
-	{
-		cc_variance += (cc_sample[i] - cc_mean)*(cc_sample[i] - cc_mean);
+		if (phases & PHASE_DERIVE)
+		{
+			random_key(key);
+			if (perf)
+				bench_counters_start(&counters);
+			cc_0 = bench_start();
+			uint8_t valid = csidh(shared_curve, key, public_curve, threads);
+			cc_1 = bench_stop();
+			if (perf && (i >= warmup))
+				bench_counters_stop(&counters, &counts[2]);
+			assert(valid);
+			if (i >= warmup)
+				bench_samples_add(&derive, cc_1 - cc_0);
+		};
 	};
+	if ((format == BENCH_TEXT) && isatty(fileno(stderr)))
+		fprintf(stderr, "\r\x1b[K");
 
-	cc_variance = cc_variance / ((double)its - 1.0);
-		
-	printf("\x1b[01;33mIterations: %lu\x1b[0m\n\n", its);
+	bench_environment env;
+	bench_summary summary;
+	bench_samples *measured[3] = {&keygen, &validation, &derive};
 
-	printf("\x1b[33mAverage number of clock cycles: \x1b[32m %f \x1b[0m\n", cc_mean);
-	printf("\x1b[33mStandar deviation of the number of clock cycles: \x1b[32m %f \x1b[0m\n", sqrt(cc_variance));
-	printf("\x1b[33mMinimum of the number clock cycles: \x1b[32m %f \x1b[0m\n", cc_min);
-	printf("\x1b[33mMaximum of the number of clock cycles: \x1b[32m %f \x1b[0m\n", cc_max);
-	printf("\n");
+	bench_environment_init(&env, "action_timing", cpu, its, warmup);
+	bench_report_begin(stdout, format, &env);
+	for (i = 0; i < 3; ++i)
+	{
+		if (measured[i]->count > 0)
+		{
+			bench_summarize(measured[i], &summary);
+			bench_report(stdout, format, measured[i]->name, &summary, first);
+			first = 0;
+		};
+	};
+	// Means per action of the counters
+	first = 1;
+	for (i = 0; perf && (i < 3); ++i)
+	{
+		if (measured[i]->count > 0)
+		{
+			bench_report_counters(counters_out, format, measured[i]->name, &counters, &counts[i], first);
+			first = 0;
+		};
+	};
+	for (i = 0; i < 3; ++i)
+		bench_samples_free(measured[i]);
+	bench_report_end(stdout, format);
+	if (perf)
+		bench_counters_close(&counters);
+	if (counters_out != stdout)
+		fclose(counters_out);
 
+#ifdef ACTION_TRACE
+	trace_summary(stderr);
+	if (trace_dump(trace_file) != 0)
+	{
+		perror(trace_file);
+		return 1;
+	};
+#else
+	(void)trace_file;
+#endif
 	return 0;
 };
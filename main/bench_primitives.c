@@ -0,0 +1,271 @@
+#include <getopt.h>
+
+#include "fp.h"
+#include "edwards_curve.h"
+#include "bench.h"
+
+// Cycles of every field and curve primitive on its own. Field operations are too short for a pair of
+// fenced counter reads, thus each of their samples times REPETITIONS dependent calls.
+#define REPETITIONS 64
+
+static size_t samples = 256;
+static bench_format format = BENCH_TEXT;
+static int first = 1;
+
+static void report(bench_samples *s, size_t divisor)
+{
+	bench_summary summary;
+	for (size_t i = 0; i < s->count; i++)
+		s->values[i] /= divisor;
+	bench_summarize(s, &summary);
+	bench_report(stdout, format, s->name, &summary, first);
+	first = 0;
+	s->count = 0;
+};
+
+// Median cycles of the last summarized samples (for the weights table)
+static uint64_t median_of(bench_samples *s)
+{
+	bench_summary summary;
+	bench_summarize(s, &summary);
+	return summary.median;
+};
+
+#define MEASURE(s, divisor, code) do {				\
+	for (size_t _k = 0; _k < samples; _k++) {		\
+		uint64_t _c0 = bench_start();			\
+		for (size_t _r = 0; _r < (divisor); _r++) {	\
+			code;					\
+		}						\
+		bench_samples_add(&(s), bench_stop() - _c0);	\
+	}							\
+} while (0)
+
+// Evicts a buffer from every cache level
+static void evict(const void *buffer, size_t bytes)
+{
+	for (size_t offset = 0; offset < bytes; offset += 64)
+		_mm_clflush((const char *)buffer + offset);
+	_mm_mfence();
+};
+
+static void usage(void)
+{
+	fprintf(stderr, "usage: bench_primitives [-n samples] [-c cpu] [-f text|json|csv] [-W weights.csv] [-P [-K counters.csv]]\n");
+	fprintf(stderr, "  -n: samples of each primitive (default: 256)\n");
+	fprintf(stderr, "  -c: pin the benchmark to this CPU\n");
+	fprintf(stderr, "  -f: output format (default: text)\n");
+	fprintf(stderr, "  -W: also write the median cycles of yMUL, yISOG and yEVAL for each l_i as CSV\n");
+	fprintf(stderr, "  -P: also read the hardware performance counters (e.g., L1 data cache misses) of yEVAL\n");
+	fprintf(stderr, "      for the largest l_i, with its kernel cached and evicted\n");
+	fprintf(stderr, "  -K: with -f csv, the file the counters are written to (default: counters.csv)\n");
+};
+
+int main(int argc, char **argv)
+{
+	int cpu = -1, option, perf = 0;
+	char *weights_file = NULL;
+	char *counters_file = "counters.csv";
+	FILE *counters_out = stdout;
+	char name[64];
+
+	while ((option = getopt(argc, argv, "hn:c:f:W:PK:")) != -1)
+	{
+		switch (option)
+		{
+			case 'n':
+				samples = strtoul(optarg, NULL, 10);
+				break;
+			case 'c':
+				cpu = atoi(optarg);
+				break;
+			case 'f':
+				if (bench_parse_format(optarg, &format) != 0)
+				{
+					usage();
+					return 1;
+				};
+				break;
+			case 'W':
+				weights_file = optarg;
+				break;
+			case 'P':
+				perf = 1;
+				break;
+			case 'K':
+				counters_file = optarg;
+				break;
+			case 'h':
+			default:
+				usage();
+				return (option == 'h') ? 0 : 1;
+		};
+	};
+	if ((cpu >= 0) && (bench_pin(cpu) != 0))
+	{
+		perror("sched_setaffinity");
+		return 1;
+	};
+
+	bench_samples s;
+	if ((samples == 0) || (bench_samples_init(&s, NULL, samples) != 0))
+	{
+		usage();
+		return 1;
+	};
+
+	bench_environment env;
+	bench_environment_init(&env, "bench_primitives", cpu, samples, 0);
+	bench_report_begin(stdout, format, &env);
+
+	// ---------------------------------------------------------------------------------------------
+	// Field arithmetic
+	fp a, b;
+	fp_random_montgomery(a);
+	fp_random_montgomery(b);
+
+	s.name = "fp_add";
+	MEASURE(s, REPETITIONS, fp_add(a, a, b));
+	report(&s, REPETITIONS);
+	s.name = "fp_sub";
+	MEASURE(s, REPETITIONS, fp_sub(a, a, b));
+	report(&s, REPETITIONS);
+	s.name = "fp_mul";
+	MEASURE(s, REPETITIONS, fp_mul(a, a, b));
+	report(&s, REPETITIONS);
+	s.name = "fp_sqr";
+	MEASURE(s, REPETITIONS, fp_sqr(a, a));
+	report(&s, REPETITIONS);
+	s.name = "fp_cswap";
+	MEASURE(s, REPETITIONS, fp_cswap(a, b, (uint8_t)(_r & 1)));
+	report(&s, REPETITIONS);
+	s.name = "fp_inv";
+	MEASURE(s, 1, fp_inv(a));
+	report(&s, 1);
+	volatile uint8_t square = 0;
+	s.name = "fp_issquare";
+	MEASURE(s, 1, square ^= fp_issquare(a); fp_add(a, a, b));
+	report(&s, 1);
+
+	// ---------------------------------------------------------------------------------------------
+	// Curve arithmetic on the base curve
+	proj A, P, Q, R, PQ;
+	point_copy(A, E);
+	elligator(P, Q, A);
+	yDBL(PQ, P, A);		// any three points work for timing a differential addition
+
+	s.name = "yDBL";
+	MEASURE(s, REPETITIONS, yDBL(P, P, A));
+	report(&s, REPETITIONS);
+	s.name = "yADD";
+	MEASURE(s, REPETITIONS, yADD(R, P, Q, PQ); point_copy(P, R));
+	report(&s, REPETITIONS);
+	s.name = "yQUAD";
+	MEASURE(s, REPETITIONS, yQUAD(P, P, A));
+	report(&s, REPETITIONS);
+	s.name = "yTPL";
+	MEASURE(s, REPETITIONS, yTPL(P, P, A));
+	report(&s, REPETITIONS);
+	s.name = "elligator";
+	MEASURE(s, 1, elligator(P, Q, A));
+	report(&s, 1);
+
+	// ---------------------------------------------------------------------------------------------
+	// Per-prime costs. The formulas are constant-time, so their cost does not depend on P having
+	// order l_i: a random point (multiplied by 4) stands for the kernel generator.
+	proj K[(LARGE_L >> 1) + 1], C;
+	uint64_t weights[N][3];
+
+	for (uint8_t i = 0; i < N; i++)
+	{
+		elligator(P, Q, A);
+		yQUAD(P, P, A);
+
+		snprintf(name, sizeof(name), "yMUL/l=%u", L[i]);
+		s.name = name;
+		MEASURE(s, 1, yMUL(Q, P, A, i));
+		weights[i][0] = median_of(&s);
+		report(&s, 1);
+
+		snprintf(name, sizeof(name), "yISOG/l=%u", L[i]);
+		MEASURE(s, 1, yISOG(K, C, P, A, i));
+		weights[i][1] = median_of(&s);
+		report(&s, 1);
+
+		snprintf(name, sizeof(name), "yEVAL/l=%u", L[i]);
+		MEASURE(s, 1, yEVAL(R, Q, (const proj *)K, i));
+		weights[i][2] = median_of(&s);
+		report(&s, 1);
+	};
+
+	// ---------------------------------------------------------------------------------------------
+	// Kernel streaming: yEVAL for the largest l_i with its kernel cached (as right after yISOG in the
+	// action) and evicted from every cache level, which is the cost the prefetching in yEVAL hides.
+	bench_counters counters;
+	bench_counts counts[2] = {0};
+	char kernel_name[2][64];
+	uint8_t largest = 0;
+
+	if (perf && (bench_counters_open(&counters) == 0))
+	{
+		fprintf(stderr, "Hardware performance counters unavailable (see /proc/sys/kernel/perf_event_paranoid)\n");
+		bench_counters_close(&counters);
+		perf = 0;
+	};
+	// In CSV, the counters are a table of their own
+	if (perf && (format == BENCH_CSV) && ((counters_out = fopen(counters_file, "w")) == NULL))
+	{
+		perror(counters_file);
+		return 1;
+	};
+	for (uint8_t i = 1; i < N; i++)
+		if (L[i] > L[largest])
+			largest = i;
+
+	elligator(P, Q, A);
+	yQUAD(P, P, A);
+	yISOG(K, C, P, A, largest);
+	for (int cold = 0; cold < 2; cold++)
+	{
+		snprintf(kernel_name[cold], sizeof(kernel_name[cold]), "yEVAL/l=%u/%s", L[largest], cold ? "evicted" : "cached");
+		s.name = kernel_name[cold];
+		for (size_t k = 0; k < samples; k++)
+		{
+			if (cold)
+				evict(K, (L[largest] >> 1) * sizeof(proj));
+			if (perf)
+				bench_counters_start(&counters);
+			uint64_t c0 = bench_start();
+			yEVAL(R, Q, (const proj *)K, largest);
+			bench_samples_add(&s, bench_stop() - c0);
+			if (perf)
+				bench_counters_stop(&counters, &counts[cold]);
+		};
+		report(&s, 1);
+	};
+	for (int cold = 0; perf && (cold < 2); cold++)
+		bench_report_counters(counters_out, format, kernel_name[cold], &counters, &counts[cold], cold == 0);
+	if (perf)
+		bench_counters_close(&counters);
+	if (counters_out != stdout)
+		fclose(counters_out);
+
+	bench_report_end(stdout, format);
+	bench_samples_free(&s);
+
+	if (weights_file != NULL)
+	{
+		FILE *out = fopen(weights_file, "w");
+		if (out == NULL)
+		{
+			perror(weights_file);
+			return 1;
+		};
+		fprintf(out, "index,l,yMUL,yISOG,yEVAL\n");
+		for (uint8_t i = 0; i < N; i++)
+			fprintf(out, "%u,%u,%lu,%lu,%lu\n", i, L[i], weights[i][0], weights[i][1], weights[i][2]);
+		fclose(out);
+	};
+	(void)square;
+	return 0;
+};
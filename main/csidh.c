@@ -2,13 +2,26 @@
 
 #include "fp.h"
 #include "edwards_curve.h"
+#include "parallel.h"
+#include "bench.h"
 
-// Measuring the perfomance
-static uint64_t get_cycles()
+// Measuring the perfomance: the hardware performance counters are optional (perf_event_open() may be
+// forbidden, or the CPU may not expose them), only the cycles are always measured.
+static bench_counters counters;
+static int perf = 0;
+
+static void print_counters(const bench_counts *counts)
 {
-   uint32_t lo, hi;
-   asm volatile("rdtsc":"=a"(lo),"=d"(hi));
-   return ((uint64_t)hi<<32) | lo;
+	if (!perf)
+		return;
+	for (int i = 0; i < BENCH_COUNTERS; i++)
+	{
+		if (counters.fd[i] >= 0)
+			printf("%s: %lu   ", BENCH_COUNTER_NAMES[i], counts->total[i]);
+	};
+	if ((counters.fd[BENCH_CYCLES] >= 0) && (counters.fd[BENCH_INSTRUCTIONS] >= 0) && (counts->total[BENCH_CYCLES] > 0))
+		printf("IPC: %.2f", (double)counts->total[BENCH_INSTRUCTIONS] / (double)counts->total[BENCH_CYCLES]);
+	printf("\n");
 };
 
 static uint8_t csidh(proj out, const uint8_t sk[], const proj in)
@@ -28,6 +41,9 @@ static uint8_t csidh(proj out, const uint8_t sk[], const proj in)
 int main()
 {
 	uint64_t c0, c1;
+	bench_counts counts;
+
+	perf = (bench_counters_open(&counters) > 0);
 
 	fp u;
 	uint8_t sk_alice[N],	// secret key of Alice
@@ -65,56 +81,56 @@ int main()
 	printf("The dummy-free case implies that the secret exponents satisfy (e_i mod 2) = (b_i mod 2).\n");
 
 	printf("-----------------------------------------------------------------------------------------------------\n");
-	printf("First step: Alice and Bob random generate a secret key, and both compute and send their public curves\n\n");
+	printf("First step: Alice random generates a secret key, and computes and sends her public curve\n\n");
 	// Alice: random key generation
 	random_key(sk_alice);
 	printf_key(sk_alice, "sk_alice");
 
 	proj E_alice;
-	c0 = get_cycles();
+	memset(&counts, 0, sizeof(counts));
+	bench_counters_start(&counters);
+	c0 = bench_start();
 	assert(csidh(E_alice, sk_alice, E));
-	c1 = get_cycles();
+	c1 = bench_stop();
+	bench_counters_stop(&counters, &counts);
 	fp_print(E_alice[0], NUMBER_OF_WORDS, 0, "E_alice_a ");
 	fp_print(E_alice[1], NUMBER_OF_WORDS, 0, "E_alice_ad");
 	printf("clock cycles: %3.03lf\n", ( 1.0 * (c1 - c0)) / (1000000.0));
+	print_counters(&counts);
 	printf("Number of field operations computed: (%lu)M + (%lu)S + (%lu)a\n\n", FP_MUL_COMPUTED, FP_SQR_COMPUTED, FP_ADD_COMPUTED);
 
-	// Bob: random key generation
-	random_key(sk_bob);
+	// Bob: random key generation and encapsulation against the public curve of Alice
+	proj E_bob, ss_bob;
+	FP_ADD_COMPUTED = 0;
+	FP_SQR_COMPUTED = 0;
+	FP_MUL_COMPUTED = 0;
+	c0 = bench_start();
+	assert(csidh_encapsulation(E_bob, ss_bob, sk_bob, E_alice));
+	c1 = bench_stop();
 	printf_key(sk_bob, "sk_bob");
-
-	proj E_bob;
-	c0 = get_cycles();
-	assert(csidh(E_bob, sk_bob, E));
-	c1 = get_cycles();
 	fp_print(E_bob[0], NUMBER_OF_WORDS, 0, "E_bob_a ");
 	fp_print(E_bob[1], NUMBER_OF_WORDS, 0, "E_bob_ad");
-	printf("clock cycles: %3.03lf\n", ( 1.0 * (c1 - c0)) / (1000000.0));
-	printf("Number of field operations computed: (%lu)M + (%lu)S + (%lu)a\n", FP_MUL_COMPUTED, FP_SQR_COMPUTED, FP_ADD_COMPUTED);
+	fp_print(ss_bob[0], NUMBER_OF_WORDS, 0, "ss_bob_a ");
+	fp_print(ss_bob[1], NUMBER_OF_WORDS, 0, "ss_bob_ad");
+	printf("clock cycles (E_bob and ss_bob computed concurrently): %3.03lf\n", ( 1.0 * (c1 - c0)) / (1000000.0));
+	printf("Number of field operations computed by the calling thread: (%lu)M + (%lu)S + (%lu)a\n", FP_MUL_COMPUTED, FP_SQR_COMPUTED, FP_ADD_COMPUTED);
 
 
 	printf("\n");	
 	printf("------------------------------------------------------------------------------------------------------------\n");
-	printf("Second step: Alice a Bob compute the shared secret by using the public curves of Bob and Alice, respectively\n");
+	printf("Second step: Alice computes the shared secret by using the public curve of Bob\n");
 	// Alice: shared secret
 	proj ss_alice;
-	c0 = get_cycles();
+	memset(&counts, 0, sizeof(counts));
+	bench_counters_start(&counters);
+	c0 = bench_start();
 	assert(csidh(ss_alice, sk_alice, E_bob));
-	c1 = get_cycles();
+	c1 = bench_stop();
+	bench_counters_stop(&counters, &counts);
 	fp_print(ss_alice[0], NUMBER_OF_WORDS, 0, "ss_alice_a ");
 	fp_print(ss_alice[1], NUMBER_OF_WORDS, 0, "ss_alice_ad");
 	printf("clock cycles: %3.03lf\n", ( 1.0 * (c1 - c0)) / (1000000.0));
-	printf("Number of field operations computed: (%lu)M + (%lu)S + (%lu)a\n", FP_MUL_COMPUTED, FP_SQR_COMPUTED, FP_ADD_COMPUTED);
-
-	printf("\n");
-	// Bob: shared secret
-	proj ss_bob;
-	c0 = get_cycles();
-	assert(csidh(ss_bob, sk_bob, E_alice));
-	c1 = get_cycles();
-	fp_print(ss_bob[0], NUMBER_OF_WORDS, 0, "ss_bob_a ");
-	fp_print(ss_bob[1], NUMBER_OF_WORDS, 0, "ss_bob_ad");
-	printf("clock cycles: %3.03lf\n", ( 1.0 * (c1 - c0)) / (1000000.0));
+	print_counters(&counts);
 	printf("Number of field operations computed: (%lu)M + (%lu)S + (%lu)a\n", FP_MUL_COMPUTED, FP_SQR_COMPUTED, FP_ADD_COMPUTED);
 	
 	printf("\n");
@@ -145,5 +161,7 @@ int main()
 	}
 	printf("\n");
 
+	if (perf)
+		bench_counters_close(&counters);
 	return 0;
 };
@@ -1,29 +1,29 @@
 #include <getopt.h>
+#include <pthread.h>
+#include <stdatomic.h>
 #include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <strings.h>
+#include <sys/socket.h>
+#include <sys/un.h>
 #include <unistd.h>
 
 #include "csidh_util.h"
+#include "csidhd.h"
+#include "keystore.h"
+#include "parallel.h"
 
-void normalize_public_key(proj public_key, fp *out) {
-    /* Compress the public key from x,y (256 bits) to x/y,NULL (128 bits) */
-    // public_key has entries x,y or public_key[0] and public_key[1]
-    fp n_public_key;
-    fp_inv(public_key[1]); // fp_inv becomes x,1/y or public_key[0] = x and public_key[1] = 1/y
-    fp_mul(n_public_key, public_key[0], public_key[1]); // normalized_public_key is x*1/y or x/y aka public_key[0]/public_key[1]
-    /* Convert to Montgomery form */
-    fp_mul(n_public_key, n_public_key, E[1]); // x/y * 4
-    fp_sub(n_public_key, n_public_key, E[0]); // x/y - 2
-    memcpy(out, n_public_key, sizeof(fp));
-}
+// The variable-time action leaks the exponents through its running time
+#if defined VARTIME
+#error "TYPE=VARTIME is only meant for public exponents, not for the secret keys handled here"
+#endif
 
-// slightly modified csidh from main/csidh.c
-static uint8_t csidh(proj out, const uint8_t sk[], const proj in)
+// slightly modified csidh from main/csidh.c: the validation runs on `threads` threads (see validate_parallel())
+static uint8_t csidh(proj out, const uint8_t sk[], const proj in, size_t threads)
 {
-  if (!validate(in)) {
+  if (!validate_parallel(in, threads)) {
     return 0;
   };
 
@@ -33,8 +33,8 @@ static uint8_t csidh(proj out, const uint8_t sk[], const proj in)
 
 void pprint_ss(uint64_t *x)
 {
-    /* for p512 we print 8 64bit little endian values as hex. */
-    int ceiling = 7;
+    /* we print NUMBER_OF_WORDS 64bit little endian values as hex (8 for p512). */
+    int ceiling = NUMBER_OF_WORDS - 1;
     int i;
     for(i=ceiling; i >= 0; --i){
         printf("%.16" PRIX64 "", x[i]);
@@ -76,6 +76,52 @@ void error_exit(char *str) {
   exit(1);
 }
 
+static int read_exactly(int fd, void *buf, size_t len) {
+  ssize_t n;
+  for (size_t i = 0; i < len; i += n) {
+    n = recv(fd, (uint8_t *)buf + i, len - i, 0);
+    if (n <= 0) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+/* Sends one request to csidhd and waits for its response; it returns the status of the response. */
+static int daemon_call(const char *socket_path, uint8_t op, const void *payload, size_t payload_length,
+                       void *response, size_t response_length) {
+  struct sockaddr_un address;
+  csidhd_request request = {.magic = CSIDHD_MAGIC, .op = op, .id = 1};
+  csidhd_response header;
+  uint8_t buffer[sizeof(csidhd_request) + N + sizeof(fp)];
+  int fd;
+
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if (strlen(socket_path) >= sizeof(address.sun_path)) {
+    error_exit("Socket path too long");
+  }
+  strcpy(address.sun_path, socket_path);
+  if ((fd = socket(AF_UNIX, SOCK_STREAM, 0)) < 0 ||
+      connect(fd, (struct sockaddr *)&address, sizeof(address)) < 0) {
+    perror(socket_path);
+    exit(1);
+  }
+
+  memcpy(buffer, &request, sizeof(request));
+  memcpy(buffer + sizeof(request), payload, payload_length);
+  if (send(fd, buffer, sizeof(request) + payload_length, MSG_NOSIGNAL) < 0 ||
+      !read_exactly(fd, &header, sizeof(header)) || header.magic != CSIDHD_MAGIC ||
+      (header.status == CSIDHD_OK && header.length != response_length) ||
+      (header.status != CSIDHD_OK && header.length != 0) ||
+      !read_exactly(fd, response, header.length)) {
+    error_exit("Unexpected response from csidhd");
+  }
+  explicit_bzero(buffer, sizeof(buffer));
+  close(fd);
+  return header.status;
+}
+
 int read_file(const char *file, uint8_t *buf, size_t len) {
   size_t c = 0;
   FILE *fhandle;
@@ -99,6 +145,182 @@ int read_stdin(uint8_t *buf, int len) {
   return c;
 }
 
+/* Batch mode: a stream of records is derived by worker threads, BATCH_CHUNK records at a time. */
+#define BATCH_CHUNK 256
+
+typedef struct {
+  uint8_t private_key[N];
+  fp public_key;      /* normalized (Montgomery form) */
+  fp shared_secret;   /* normalized (Montgomery form) */
+  int valid;
+} batch_record;
+
+typedef struct {
+  batch_record *records;
+  size_t count;
+  atomic_size_t next;
+} batch_chunk;
+
+static int hex_value(int c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+/* Parses len bytes of hex (leading blanks are skipped); returns the number of characters consumed, or 0. */
+static size_t parse_hex(const char *str, uint8_t *buf, size_t len) {
+  size_t c = 0;
+  int hi, lo;
+  while (str[c] == ' ' || str[c] == '\t') {
+    c += 1;
+  }
+  for (size_t i = 0; i < len; ++i, c += 2) {
+    if ((hi = hex_value(str[c])) < 0 || (lo = hex_value(str[c + 1])) < 0) {
+      return 0;
+    }
+    buf[i] = (uint8_t)((hi << 4) | lo);
+  }
+  return c;
+}
+
+/* Returns 1 if a record was read, 0 at the end of the stream, and -1 on a malformed record. */
+static int read_record(FILE *in, int raw, int with_private_key, batch_record *record) {
+  static char *line = NULL;
+  static size_t capacity = 0;
+  size_t c = 0, n;
+
+  if (raw) {
+    if (with_private_key) {
+      n = fread(record->private_key, 1, sizeof(record->private_key), in);
+      if (n != sizeof(record->private_key)) {
+        return (n == 0 && feof(in)) ? 0 : -1;
+      }
+    }
+    n = fread(record->public_key, 1, sizeof(fp), in);
+    if (n != sizeof(fp)) {
+      return (n == 0 && feof(in) && !with_private_key) ? 0 : -1;
+    }
+    return 1;
+  }
+
+  do {
+    if (getline(&line, &capacity, in) < 0) {
+      explicit_bzero(line, capacity);
+      return 0;
+    }
+  } while (line[strspn(line, " \t\r\n")] == '\0'); /* blank lines are skipped */
+
+  if (with_private_key) {
+    if ((c = parse_hex(line, record->private_key, sizeof(record->private_key))) == 0) {
+      return -1;
+    }
+  }
+  n = parse_hex(line + c, (uint8_t *)record->public_key, sizeof(fp));
+  if (n > 0 && line[c + n + strspn(line + c + n, " \t\r\n")] != '\0') {
+    n = 0; /* only whitespace may follow the public key */
+  }
+  explicit_bzero(line, capacity);
+  return (n == 0) ? -1 : 1;
+}
+
+static void write_record(FILE *out, int raw, const batch_record *record) {
+  if (raw) {
+    uint8_t status = (uint8_t)record->valid;
+    fwrite(&status, 1, 1, out);
+    fwrite(record->shared_secret, 1, sizeof(fp), out);
+  } else if (record->valid) {
+    pprint_ss((uint64_t *)record->shared_secret);
+  } else {
+    printf("invalid\n");
+  }
+}
+
+static void *batch_worker(void *arg) {
+  batch_chunk *chunk = (batch_chunk *)arg;
+  proj expanded_public_key, shared_secret_key;
+  size_t i;
+
+  while ((i = atomic_fetch_add(&chunk->next, 1)) < chunk->count) {
+    batch_record *record = &chunk->records[i];
+    expand_public_key(expanded_public_key, record->public_key);
+    record->valid = csidh(shared_secret_key, record->private_key, expanded_public_key, 1);
+    if (record->valid) {
+      normalize_public_key(shared_secret_key, &record->shared_secret);
+    } else {
+      explicit_bzero(record->shared_secret, sizeof(fp));
+    }
+  }
+  explicit_bzero(shared_secret_key, sizeof(proj));
+  return NULL;
+}
+
+/* Derives every record of the stream with up to `threads` workers; the output keeps the input order. */
+static int batch_derivation(FILE *in, int raw, const uint8_t *fixed_private_key, size_t threads) {
+  batch_record *records = calloc(BATCH_CHUNK, sizeof(batch_record));
+  pthread_t *workers = calloc(threads, sizeof(pthread_t));
+  fp *public_keys = calloc(BATCH_CHUNK, sizeof(fp));
+  fp *shared_secrets = calloc(BATCH_CHUNK, sizeof(fp));
+  uint8_t valid[BATCH_CHUNK];
+  batch_chunk chunk;
+  size_t i, spawned;
+  int status = 1, r = 1;
+
+  if (records == NULL || workers == NULL || public_keys == NULL || shared_secrets == NULL) {
+    error_exit("Unable to allocate the batch buffers");
+  }
+
+  while (r == 1) {
+    for (chunk.count = 0; chunk.count < BATCH_CHUNK; chunk.count += 1) {
+      r = read_record(in, raw, fixed_private_key == NULL, &records[chunk.count]);
+      if (r != 1) {
+        break;
+      }
+    }
+    if (r < 0) {
+      fprintf(stderr, "Malformed record %zu in the batch\n", chunk.count + 1);
+      status = 0;
+    }
+
+    if (fixed_private_key != NULL) {
+      /* Static key: derive_many() normalizes the whole chunk with a single inversion */
+      for (i = 0; i < chunk.count; ++i) {
+        memcpy(public_keys[i], records[i].public_key, sizeof(fp));
+      }
+      derive_many(fixed_private_key, (const fp *)public_keys, chunk.count, shared_secrets, valid, threads);
+      for (i = 0; i < chunk.count; ++i) {
+        memcpy(records[i].shared_secret, shared_secrets[i], sizeof(fp));
+        records[i].valid = valid[i];
+      }
+      explicit_bzero(shared_secrets, sizeof(fp) * BATCH_CHUNK);
+    } else {
+      chunk.records = records;
+      atomic_init(&chunk.next, 0);
+      for (spawned = 0; spawned < threads - 1 && spawned + 1 < chunk.count; ++spawned) {
+        if (pthread_create(&workers[spawned], NULL, batch_worker, &chunk) != 0) {
+          break;
+        }
+      }
+      batch_worker(&chunk);
+      for (i = 0; i < spawned; ++i) {
+        pthread_join(workers[i], NULL);
+      }
+    }
+
+    for (i = 0; i < chunk.count; ++i) {
+      write_record(stdout, raw, &records[i]);
+    }
+    explicit_bzero(records, sizeof(batch_record) * BATCH_CHUNK);
+  }
+
+  fflush(stdout);
+  free(records);
+  free(workers);
+  free(public_keys);
+  free(shared_secrets);
+  return status;
+}
+
 int main(int argc, char **argv) {
   uint8_t private_key[N];
   proj expanded_public_key;
@@ -115,11 +337,19 @@ int main(int argc, char **argv) {
   size_t verbose = 0;
   size_t generation_mode = 0;
   size_t derivation_mode = 0;
+  size_t encapsulation_mode = 0;
+  size_t speculative = 0;
+  size_t batch_mode = 0;
+  size_t raw_records = 0;
+  size_t threads = 0;
+  char *batch_file = NULL;
+  char *daemon_socket = NULL;
+  char *keystore_file = NULL;
   size_t error = 0;
   char *priv_key_file = NULL;
   char *pub_key_file = NULL;
 
-  while ((option = getopt(argc, argv, "hvVgdp:s:")) != -1) {
+  while ((option = getopt(argc, argv, "hvVtgdeSbri:j:k:p:s:u:")) != -1) {
     switch (option) {
     case 'V':
       fprintf(stderr, "csidh-p%i-util version: %f\n", BITS, VERSION);
@@ -127,27 +357,70 @@ int main(int argc, char **argv) {
     case 'h':
       fprintf(stderr, "csidh-p%i-util version: %f\n", BITS, VERSION);
       fprintf(stderr, "  -V: print version\n");
+      fprintf(stderr, "  -t: run the known-answer test of the random number generator (ChaCha20)\n");
       fprintf(stderr, "  -verbose: increase verbosity\n");
       fprintf(stderr, "  -g: key generation mode\n");
       fprintf(stderr, "  -d: key derivation mode\n");
+      fprintf(stderr, "  -e: encapsulation mode (fresh key pair and shared secret against -p)\n");
+      fprintf(stderr, "  -S: speculative derivation (validation runs concurrently with the action)\n");
+      fprintf(stderr, "  -b: batch derivation mode: one shared secret per (private key, public key) record,\n");
+      fprintf(stderr, "      or per public key record if -s is given (output keeps the input order)\n");
+      fprintf(stderr, "  -r: raw binary records for -b instead of hex lines\n");
+      fprintf(stderr, "  -i: batch input file name (default: stdin)\n");
+      fprintf(stderr, "  -j: number of worker threads for -b (default: online CPUs), and of the validation of -d (default: 1)\n");
+      fprintf(stderr, "  -u: send -g and -d requests to the csidhd daemon listening on this socket\n");
+      fprintf(stderr, "  -k: keystore file for -d: -p is then the name of a key of the keystore\n");
       fprintf(stderr, "  -p: public key file name\n");
       fprintf(stderr, "  -s: private key file name\n");
       return 0;
+    case 't':
+      if (randombytes_selftest() != 0) {
+        error_exit("randombytes_selftest: failed");
+      }
+      fprintf(stderr, "randombytes_selftest: ok\n");
+      return 0;
     case 'v':
       verbose += 1;
       break;
     case 'g':
       generation_mode = 1;
-      if (derivation_mode) {
+      if (derivation_mode || encapsulation_mode) {
         error += 1;
       };
       break;
     case 'd':
       derivation_mode = 1;
-      if (generation_mode) {
+      if (generation_mode || encapsulation_mode) {
+        error = 1;
+      };
+      break;
+    case 'e':
+      encapsulation_mode = 1;
+      if (generation_mode || derivation_mode) {
         error = 1;
       };
       break;
+    case 'S':
+      speculative = 1;
+      break;
+    case 'b':
+      batch_mode = 1;
+      break;
+    case 'r':
+      raw_records = 1;
+      break;
+    case 'i':
+      batch_file = optarg;
+      break;
+    case 'j':
+      threads = strtoul(optarg, NULL, 10);
+      break;
+    case 'u':
+      daemon_socket = optarg;
+      break;
+    case 'k':
+      keystore_file = optarg;
+      break;
     case 'p':
       pub_key_file = optarg;
       if (verbose) {
@@ -165,6 +438,15 @@ int main(int argc, char **argv) {
     }
   }
 
+  if (batch_mode && (generation_mode || derivation_mode || encapsulation_mode)) {
+    error = 1;
+  }
+  if (daemon_socket != NULL && (batch_mode || encapsulation_mode || speculative)) {
+    error = 1;
+  }
+  if (keystore_file != NULL && (!derivation_mode || pub_key_file == NULL)) {
+    error = 1;
+  }
   if (error) {
     error_exit("Mutually exclusive options chosen");
   }
@@ -173,10 +455,24 @@ int main(int argc, char **argv) {
     if (verbose) {
       fprintf(stderr, "Key generation mode\n");
     }
-    random_key(private_key);
-    csidh_validate = csidh(public_key, private_key, E);
-    if (!csidh_validate) {
-      error_exit("csidh_validate: failed");
+    fp normalized_public_key;
+    explicit_bzero(&normalized_public_key, sizeof(fp));
+    if (daemon_socket != NULL) {
+      uint8_t key_pair[N + sizeof(fp)];
+      if (daemon_call(daemon_socket, CSIDHD_KEYGEN, NULL, 0, key_pair, sizeof(key_pair)) != CSIDHD_OK) {
+        error_exit("csidhd: key generation failed");
+      }
+      memcpy(private_key, key_pair, N);
+      memcpy(normalized_public_key, key_pair + N, sizeof(fp));
+      explicit_bzero(key_pair, sizeof(key_pair));
+    } else {
+      random_key(private_key);
+      csidh_validate = csidh(public_key, private_key, E, 1);
+      if (!csidh_validate) {
+        error_exit("csidh_validate: failed");
+      }
+      /* Normalize (aka compress) the public key in size from 256 bits to 128 bits. */
+      normalize_public_key(public_key, &normalized_public_key);
     }
     if (priv_key_file == NULL){
       pprint_sk(private_key);
@@ -185,10 +481,6 @@ int main(int argc, char **argv) {
       save_file(priv_key_file, &private_key, sizeof(uint8_t [N]));
     }
 
-    /* Normalize (aka compress) the public key in size from 256 bits to 128 bits. */
-    fp normalized_public_key;
-    explicit_bzero(&normalized_public_key, sizeof(fp));
-    normalize_public_key(public_key, &normalized_public_key);
     if (pub_key_file == NULL){
       pprint_pk(normalized_public_key);
     } else {
@@ -211,40 +503,58 @@ int main(int argc, char **argv) {
       error_exit("Unable to read correct number of bytes for private key");
     }
 
-    if ((sizeof(public_key)/2) !=
+    int validated = 0;
+    if (keystore_file != NULL) {
+      /* The public key comes from the keystore, already expanded and possibly already validated */
+      keystore *ks = keystore_open(keystore_file);
+      const keystore_entry *entry = (ks != NULL) ? keystore_find(ks, pub_key_file) : NULL;
+      if (entry == NULL) {
+        error_exit("Unable to find the public key in the keystore");
+      }
+      memcpy(public_key[0], keystore_public_key(ks, entry), sizeof(fp));
+      validated = keystore_curve(expanded_public_key, ks, entry);
+      keystore_close(ks);
+    } else if ((sizeof(public_key)/2) !=
         ((pub_key_file != NULL)
              ? read_file(pub_key_file, (uint8_t *)public_key,
                          (sizeof(proj)/2))
              : read_stdin((uint8_t *)public_key, (sizeof(proj)/2)))) {
       error_exit("Unable to read correct number of bytes for public key");
+    } else {
+      expand_public_key(expanded_public_key, public_key[0]);
     }
 
-    /* Expand the normalized key and convert from Montgomery to Edwards form. */
-    /*
-     * If one wanted to use Edwards rather than Montgomery, the three lines
-     * below could be replaced with the following two lines:
-     *
-     *  memcpy(expanded_public_key[1], R_mod_p, (sizeof(expanded_public_key[1])));
-     *  memcpy(expanded_public_key[0], public_key, (sizeof(expanded_public_key[0])));
-     *
-     * */
-    memcpy(expanded_public_key[1], E[1], (sizeof(expanded_public_key[1]))); // E[1] ==2
-    memcpy(expanded_public_key[0], public_key, (sizeof(expanded_public_key[0]))); // Original value from user in Montgomery form
-    fp_add(expanded_public_key[0], expanded_public_key[0], E[0]); // E[0] == 4
+    if (daemon_socket != NULL) {
+      uint8_t request[N + sizeof(fp)];
+      fp shared_secret;
+      memcpy(request, private_key, N);
+      memcpy(request + N, public_key[0], sizeof(fp));
+      csidh_validate = (daemon_call(daemon_socket, CSIDHD_DERIVE, request, sizeof(request), shared_secret,
+                                    sizeof(fp)) == CSIDHD_OK);
+      explicit_bzero(request, sizeof(request));
+      if (!csidh_validate) {
+        error_exit("csidh_validate: failed");
+      }
+      pprint_ss(shared_secret);
+      return 0;
+    }
 
     /* Operate on the expanded public key. */
-    csidh_validate = csidh(shared_secret_key, private_key, expanded_public_key);
+    if (validated) {
+      action_evaluation(shared_secret_key, private_key, expanded_public_key);
+      csidh_validate = 1;
+    } else {
+      csidh_validate = speculative
+                           ? csidh_speculative(shared_secret_key, private_key, expanded_public_key)
+                           : csidh(shared_secret_key, private_key, expanded_public_key, threads);
+    }
     if (!csidh_validate) {
       error_exit("csidh_validate: failed");
     }
 
-    /* Normalize our shared secret. */
+    /* Normalize our shared secret and convert it from Edwards to Montgomery. */
     fp shared_secret;
-    fp_inv(shared_secret_key[1]);
-    fp_mul(shared_secret, shared_secret_key[0], shared_secret_key[1]);
-    /* Convert from Edwards to Montgomery. */
-    fp_mul(shared_secret, shared_secret, E[1]); // x/y * 4
-    fp_sub(shared_secret, shared_secret, E[0]); // x/y - 2
+    normalize_public_key(shared_secret_key, &shared_secret);
 
     if (verbose) {
       pprint_sk(private_key);
@@ -256,5 +566,66 @@ int main(int argc, char **argv) {
     return 0;
   }
 
+  if (batch_mode) {
+    FILE *in = stdin;
+    int ok;
+    if (verbose) {
+      fprintf(stderr, "Batch derivation mode\n");
+    }
+    if (threads == 0) {
+      long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+      threads = (cpus > 0) ? (size_t)cpus : 1;
+    }
+    if (priv_key_file != NULL &&
+        sizeof(private_key) != read_file(priv_key_file, (uint8_t *)&private_key, sizeof(private_key))) {
+      error_exit("Unable to read correct number of bytes for private key");
+    }
+    if (batch_file != NULL && (in = fopen(batch_file, raw_records ? "rb" : "r")) == NULL) {
+      fprintf(stderr, "Unable to open %s\n", batch_file);
+      exit(3);
+    }
+    ok = batch_derivation(in, raw_records, (priv_key_file != NULL) ? private_key : NULL, threads);
+    explicit_bzero(&private_key, sizeof(private_key));
+    if (in != stdin) {
+      fclose(in);
+    }
+    return ok ? 0 : 1;
+  }
+
+  if (encapsulation_mode) {
+    if (verbose) {
+      fprintf(stderr, "Encapsulation mode\n");
+    }
+
+    if ((sizeof(public_key)/2) !=
+        ((pub_key_file != NULL)
+             ? read_file(pub_key_file, (uint8_t *)public_key,
+                         (sizeof(proj)/2))
+             : read_stdin((uint8_t *)public_key, (sizeof(proj)/2)))) {
+      error_exit("Unable to read correct number of bytes for public key");
+    }
+    expand_public_key(expanded_public_key, public_key[0]);
+
+    /* Our public key and the shared secret are computed concurrently. */
+    csidh_validate = csidh_encapsulation(public_key, shared_secret_key, private_key, expanded_public_key);
+    if (!csidh_validate) {
+      error_exit("csidh_validate: failed");
+    }
+    if (priv_key_file == NULL){
+      pprint_sk(private_key);
+    } else {
+      if (verbose) { pprint_sk(private_key); }
+      save_file(priv_key_file, &private_key, sizeof(uint8_t [N]));
+    }
+
+    /* Output our normalized public key first, and then the shared secret. */
+    fp normalized_public_key, shared_secret;
+    normalize_public_key(public_key, &normalized_public_key);
+    normalize_public_key(shared_secret_key, &shared_secret);
+    pprint_pk(normalized_public_key);
+    pprint_ss(shared_secret);
+    return 0;
+  }
+
   return 1;
 }
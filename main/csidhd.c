@@ -0,0 +1,451 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <poll.h>
+#include <signal.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "csidh_util.h"
+#include "async.h"
+#include "csidhd.h"
+#include "key_pool.h"
+
+// The variable-time action leaks the exponents through its running time
+#if defined VARTIME
+#error "TYPE=VARTIME is only meant for public exponents, not for the secret keys handled here"
+#endif
+
+/*
+ * csidhd: long-lived key-derivation daemon. The main thread runs a poll() loop over the listening
+ * socket, the client connections and the completion descriptor of a csidh_async queue (lib/async.c):
+ * complete requests are submitted to its workers, and the responses are written back to the clients
+ * that are still connected once csidh_poll() returns them. The connections are non-blocking: responses
+ * that a client does not read yet wait in its output buffer, which is flushed when poll() reports POLLOUT,
+ * so a slow reader never stalls the loop.
+ */
+
+#define MAX_CLIENTS 1024
+#define POLL_BATCH 64
+#define MAX_PAYLOAD (N + sizeof(fp))
+#define MAX_OUTPUT (1 << 20) /* unread responses kept for a client before it is disconnected */
+
+typedef struct {
+  csidh_request request; /* request.user_data points back to the job */
+  uint8_t op;
+  uint64_t id;
+  int client;           /* index in clients[] */
+  uint64_t generation;  /* generation of clients[client] when the request was received */
+  struct timespec received;
+} job;
+
+typedef struct {
+  int fd;
+  uint64_t generation;
+  size_t received;
+  uint8_t buffer[sizeof(csidhd_request) + MAX_PAYLOAD];
+  uint8_t *output; /* responses not sent yet (they may hold secret keys) */
+  size_t output_length, output_capacity;
+} client;
+
+static client clients[MAX_CLIENTS];
+static struct pollfd fds[MAX_CLIENTS + 2];
+
+static csidh_async *queue = NULL;
+static key_pool *pool = NULL;
+static csidhd_stats stats;
+static volatile sig_atomic_t terminate = 0;
+
+void error_exit(char *str) {
+  fprintf(stderr, "%s\n", str);
+  exit(1);
+}
+
+static void on_signal(int sig) {
+  (void)sig;
+  terminate = 1;
+}
+
+static size_t payload_length(uint8_t op) {
+  return (op == CSIDHD_DERIVE) ? MAX_PAYLOAD : 0;
+}
+
+static void close_client(int c) {
+  if (clients[c].fd < 0) {
+    return;
+  }
+  close(clients[c].fd);
+  explicit_bzero(clients[c].buffer, sizeof(clients[c].buffer));
+  if (clients[c].output != NULL) {
+    explicit_bzero(clients[c].output, clients[c].output_capacity);
+    free(clients[c].output);
+  }
+  clients[c].output = NULL;
+  clients[c].output_length = 0;
+  clients[c].output_capacity = 0;
+  clients[c].fd = -1;
+  clients[c].received = 0;
+  clients[c].generation += 1; /* pending responses of this connection are dropped */
+}
+
+/* Sends as much of the output buffer as the socket takes without blocking. */
+static void flush_client(int c) {
+  ssize_t n;
+
+  while (clients[c].output_length > 0) {
+    n = send(clients[c].fd, clients[c].output, clients[c].output_length, MSG_NOSIGNAL | MSG_DONTWAIT);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      return; /* the rest goes once poll() reports POLLOUT */
+    }
+    if (n <= 0) {
+      perror("send");
+      close_client(c);
+      return;
+    }
+    memmove(clients[c].output, clients[c].output + n, clients[c].output_length - n);
+    clients[c].output_length -= n;
+    explicit_bzero(clients[c].output + clients[c].output_length, n);
+  }
+}
+
+static void send_response(int c, uint64_t generation, uint8_t op, uint8_t status, uint64_t id,
+                          const void *payload, uint16_t length) {
+  csidhd_response header = {.magic = CSIDHD_MAGIC, .op = op, .status = status, .length = length, .id = id};
+  size_t needed, capacity;
+  uint8_t *output;
+
+  if (clients[c].fd < 0 || clients[c].generation != generation) {
+    return; /* the client is gone */
+  }
+  needed = clients[c].output_length + sizeof(header) + length;
+  if (needed > MAX_OUTPUT) {
+    fprintf(stderr, "client %d does not read its responses: disconnected\n", c);
+    close_client(c);
+    return;
+  }
+  if (needed > clients[c].output_capacity) {
+    /* The old buffer is wiped rather than realloc()'ed, since it may hold secret keys */
+    capacity = (clients[c].output_capacity > 0) ? clients[c].output_capacity : 256;
+    while (capacity < needed) {
+      capacity *= 2;
+    }
+    if ((output = malloc(capacity)) == NULL) {
+      close_client(c);
+      return;
+    }
+    if (clients[c].output != NULL) {
+      memcpy(output, clients[c].output, clients[c].output_length);
+      explicit_bzero(clients[c].output, clients[c].output_capacity);
+      free(clients[c].output);
+    }
+    clients[c].output = output;
+    clients[c].output_capacity = capacity;
+  }
+  memcpy(clients[c].output + clients[c].output_length, &header, sizeof(header));
+  if (length > 0) {
+    memcpy(clients[c].output + clients[c].output_length + sizeof(header), payload, length);
+  }
+  clients[c].output_length = needed;
+  flush_client(c);
+}
+
+static void record_latency(uint64_t histogram[], const struct timespec *since) {
+  struct timespec now;
+  uint64_t us;
+  int bucket = 0;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  us = (uint64_t)(now.tv_sec - since->tv_sec) * 1000000 + (now.tv_nsec - since->tv_nsec) / 1000;
+  while ((us >> 1) > 0 && bucket < CSIDHD_HISTOGRAM - 1) {
+    us >>= 1;
+    bucket += 1;
+  }
+  histogram[bucket] += 1;
+}
+
+static void deliver_completions(void) {
+  csidh_request *completed[POLL_BATCH];
+  uint8_t payload[MAX_PAYLOAD];
+  uint16_t length;
+  fp normalized;
+  size_t n, i;
+  job *j;
+
+  while ((n = csidh_poll(queue, completed, POLL_BATCH)) > 0) {
+    for (i = 0; i < n; ++i) {
+      j = (job *)completed[i]->user_data;
+      length = 0;
+      if (j->request.valid) {
+        /* The normalization costs one inversion: negligible next to the action */
+        normalize_public_key(j->request.out, &normalized);
+        if (j->op == CSIDHD_KEYGEN) {
+          memcpy(payload, j->request.sk, N);
+          memcpy(payload + N, normalized, sizeof(fp));
+          length = MAX_PAYLOAD;
+        } else {
+          memcpy(payload, normalized, sizeof(fp));
+          length = sizeof(fp);
+        }
+      }
+      record_latency((j->op == CSIDHD_DERIVE) ? stats.derive_latency : stats.keygen_latency, &j->received);
+      stats.completed += 1;
+      stats.invalid += !j->request.valid;
+      send_response(j->client, j->generation, j->op, j->request.valid ? CSIDHD_OK : CSIDHD_INVALID, j->id,
+                    payload, length);
+      explicit_bzero(payload, sizeof(payload));
+      explicit_bzero(j, sizeof(job));
+      free(j);
+    }
+  }
+}
+
+static void handle_request(int c, size_t max_queue) {
+  csidhd_request header;
+  job *j;
+  key_pool_stats pool_stats;
+  size_t queued, running;
+
+  memcpy(&header, clients[c].buffer, sizeof(header));
+  csidh_async_counts(queue, &queued, &running);
+  if (header.op == CSIDHD_STATS) {
+    key_pool_get_stats(pool, &pool_stats);
+    stats.queue_depth = queued;
+    stats.in_flight = running;
+    stats.pool_available = pool_stats.available;
+    stats.pool_depleted = pool_stats.depleted;
+    send_response(c, clients[c].generation, header.op, CSIDHD_OK, header.id, &stats, sizeof(stats));
+    return;
+  }
+
+  if (queued >= max_queue || (j = calloc(1, sizeof(job))) == NULL) {
+    stats.busy += 1;
+    send_response(c, clients[c].generation, header.op, CSIDHD_BUSY, header.id, NULL, 0);
+    return;
+  }
+  j->op = header.op;
+  j->id = header.id;
+  j->client = c;
+  j->generation = clients[c].generation;
+  clock_gettime(CLOCK_MONOTONIC, &j->received);
+  j->request.user_data = j;
+  if (header.op == CSIDHD_DERIVE) {
+    j->request.op = CSIDH_ASYNC_DERIVE;
+    memcpy(j->request.sk, clients[c].buffer + sizeof(header), N);
+    expand_public_key(j->request.in, (const uint64_t *)(clients[c].buffer + sizeof(header) + N));
+  } else {
+    j->request.op = CSIDH_ASYNC_KEYGEN;
+  }
+  csidh_submit(queue, &j->request);
+}
+
+/* Reads what is available on a connection, and queues every complete request. */
+static void read_client(int c, size_t max_queue) {
+  csidhd_request header;
+  size_t expected;
+  ssize_t n;
+
+  while (1) {
+    expected = sizeof(header);
+    if (clients[c].received >= sizeof(header)) {
+      memcpy(&header, clients[c].buffer, sizeof(header));
+      if (header.magic != CSIDHD_MAGIC ||
+          (header.op != CSIDHD_DERIVE && header.op != CSIDHD_KEYGEN && header.op != CSIDHD_STATS)) {
+        send_response(c, clients[c].generation, header.op, CSIDHD_BAD_REQUEST, header.id, NULL, 0);
+        close_client(c);
+        return;
+      }
+      expected += payload_length(header.op);
+    }
+    if (clients[c].received == expected) {
+      handle_request(c, max_queue);
+      if (clients[c].fd < 0) {
+        return; /* dropped while answering */
+      }
+      explicit_bzero(clients[c].buffer, sizeof(clients[c].buffer));
+      clients[c].received = 0;
+      continue;
+    }
+    n = recv(clients[c].fd, clients[c].buffer + clients[c].received, expected - clients[c].received, MSG_DONTWAIT);
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+      return; /* nothing more for now */
+    }
+    if (n <= 0) {
+      close_client(c);
+      return;
+    }
+    clients[c].received += n;
+  }
+}
+
+static void print_stats(FILE *out) {
+  fprintf(out, "queue_depth=%lu in_flight=%lu completed=%lu invalid=%lu busy=%lu\n", stats.queue_depth,
+          stats.in_flight, stats.completed, stats.invalid, stats.busy);
+  fprintf(out, "latency (us)      derive     keygen\n");
+  for (int i = 0; i < CSIDHD_HISTOGRAM; ++i) {
+    if (stats.derive_latency[i] || stats.keygen_latency[i]) {
+      fprintf(out, "  [2^%-2d, 2^%-2d) %10lu %10lu\n", i, i + 1, stats.derive_latency[i], stats.keygen_latency[i]);
+    }
+  }
+}
+
+int main(int argc, char **argv) {
+  char *socket_path = CSIDHD_SOCKET;
+  size_t threads = 0, max_queue = 4096, pool_depth = 16;
+  int option, listen_fd, c, nfds;
+  struct sockaddr_un address;
+  struct sigaction action;
+  size_t queued, running;
+  key_pool_stats pool_stats;
+
+  while ((option = getopt(argc, argv, "hs:j:q:k:")) != -1) {
+    switch (option) {
+    case 's':
+      socket_path = optarg;
+      break;
+    case 'j':
+      threads = strtoul(optarg, NULL, 10);
+      break;
+    case 'q':
+      max_queue = strtoul(optarg, NULL, 10);
+      break;
+    case 'k':
+      pool_depth = strtoul(optarg, NULL, 10);
+      break;
+    case 'h':
+    default:
+      fprintf(stderr, "csidhd version: %f\n", VERSION);
+      fprintf(stderr, "  -s: socket path (default: %s)\n", CSIDHD_SOCKET);
+      fprintf(stderr, "  -j: number of worker threads (default: online CPUs)\n");
+      fprintf(stderr, "  -q: maximum number of queued requests (default: 4096)\n");
+      fprintf(stderr, "  -k: number of precomputed key pairs for keygen requests (default: 16)\n");
+      return (option == 'h') ? 0 : 1;
+    }
+  }
+  if (threads == 0) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    threads = (cpus > 0) ? (size_t)cpus : 1;
+  }
+
+  memset(&action, 0, sizeof(action));
+  action.sa_handler = on_signal;
+  sigaction(SIGINT, &action, NULL);
+  sigaction(SIGTERM, &action, NULL);
+
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  /* Another csidhd answering at socket_path keeps it: a stale socket file is replaced */
+  if (snprintf(address.sun_path, sizeof(address.sun_path), "%s", socket_path) >= (int)sizeof(address.sun_path)) {
+    error_exit("Socket path too long");
+  }
+  if ((listen_fd = socket(AF_UNIX, SOCK_STREAM, 0)) < 0) {
+    perror("socket");
+    return 1;
+  }
+  if (connect(listen_fd, (struct sockaddr *)&address, sizeof(address)) == 0) {
+    fprintf(stderr, "%s: a csidhd is already running there\n", socket_path);
+    close(listen_fd);
+    return 1;
+  }
+  close(listen_fd);
+  /* The socket is bound to a temporary name, and only appears at socket_path once it accepts connections */
+  if (snprintf(address.sun_path, sizeof(address.sun_path), "%s.%d", socket_path, (int)getpid()) >=
+      (int)sizeof(address.sun_path)) {
+    error_exit("Socket path too long");
+  }
+  unlink(address.sun_path);
+  umask(0077); /* secret keys go through the socket: only the owner can connect */
+  if ((listen_fd = socket(AF_UNIX, SOCK_STREAM, 0)) < 0 ||
+      bind(listen_fd, (struct sockaddr *)&address, sizeof(address)) < 0 || listen(listen_fd, 64) < 0 ||
+      rename(address.sun_path, socket_path) < 0) {
+    perror(socket_path);
+    unlink(address.sun_path);
+    return 1;
+  }
+
+  if ((pool = key_pool_create(pool_depth ? pool_depth : 1, 1)) == NULL) {
+    error_exit("Unable to start the key pool");
+  }
+  key_pool_get_stats(pool, &pool_stats);
+  if (!pool_stats.locked) {
+    fprintf(stderr, "csidhd: the key pool could not be locked in memory (see RLIMIT_MEMLOCK)\n");
+  }
+  if ((queue = csidh_async_create(threads, pool)) == NULL) {
+    error_exit("Unable to start the workers");
+  }
+  for (c = 0; c < MAX_CLIENTS; ++c) {
+    clients[c].fd = -1;
+  }
+
+  while (!terminate) {
+    fds[0].fd = listen_fd;
+    fds[0].events = POLLIN;
+    fds[1].fd = csidh_async_fd(queue);
+    fds[1].events = POLLIN;
+    for (c = 0; c < MAX_CLIENTS; ++c) {
+      fds[c + 2].fd = clients[c].fd; /* negative descriptors are ignored by poll() */
+      fds[c + 2].events = POLLIN | ((clients[c].output_length > 0) ? POLLOUT : 0);
+      fds[c + 2].revents = 0;
+    }
+    nfds = poll(fds, MAX_CLIENTS + 2, -1);
+    if (nfds < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      perror("poll");
+      break;
+    }
+
+    if (fds[1].revents & POLLIN) {
+      deliver_completions();
+    }
+    for (c = 0; c < MAX_CLIENTS; ++c) {
+      if ((fds[c + 2].revents & POLLOUT) && clients[c].fd >= 0) {
+        flush_client(c);
+      }
+      if ((fds[c + 2].revents & (POLLIN | POLLHUP | POLLERR)) && clients[c].fd >= 0) {
+        read_client(c, max_queue);
+      }
+    }
+    if (fds[0].revents & POLLIN) {
+      int fd = accept(listen_fd, NULL, NULL);
+      for (c = 0; c < MAX_CLIENTS && clients[c].fd >= 0; ++c)
+        ;
+      if (fd >= 0 && (c == MAX_CLIENTS || fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK) < 0)) {
+        close(fd);
+      } else if (fd >= 0) {
+        clients[c].fd = fd;
+        clients[c].received = 0;
+      }
+    }
+  }
+
+  /* Pending requests are completed (and their responses dropped) before the workers stop */
+  for (c = 0; c < MAX_CLIENTS; ++c) {
+    if (clients[c].fd >= 0) {
+      close_client(c);
+    }
+  }
+  fds[1].fd = csidh_async_fd(queue);
+  fds[1].events = POLLIN;
+  do {
+    deliver_completions();
+    csidh_async_counts(queue, &queued, &running);
+  } while ((queued + running) > 0 && poll(&fds[1], 1, -1) >= 0);
+  deliver_completions();
+  csidh_async_destroy(queue);
+  key_pool_destroy(pool);
+  close(listen_fd);
+  unlink(socket_path);
+  print_stats(stderr);
+  return 0;
+}
@@ -0,0 +1,129 @@
+#include <getopt.h>
+#include <libgen.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "keystore.h"
+
+// The variable-time action leaks the exponents through its running time
+#if defined VARTIME
+#error "TYPE=VARTIME is only meant for public exponents, not for the secret keys handled here"
+#endif
+
+#define VERSION 0.1
+#define PK_SUFFIX ".montgomery.le.pk"
+
+/* Reads a public key stored as hex (the format of sample-keys/1.montgomery.le.pk and of csidh-p512-util -g). */
+static int read_hex_key(const char *file, fp key) {
+  FILE *fhandle = fopen(file, "r");
+  size_t c = 0;
+  if (fhandle == NULL) {
+    fprintf(stderr, "Unable to open %s\n", file);
+    return 0;
+  }
+  for (size_t i = 0; i < sizeof(fp); ++i) {
+    c += fscanf(fhandle, "%02hhx", &((uint8_t *)key)[i]);
+  }
+  fclose(fhandle);
+  return c == sizeof(fp);
+}
+
+static void print_hex_key(FILE *out, const uint64_t *key) {
+  for (size_t i = 0; i < sizeof(fp); ++i) {
+    fprintf(out, "%02hhx", ((const uint8_t *)key)[i]);
+  }
+  fprintf(out, "\n");
+}
+
+/* The name of a key is the name of its file without directory nor PK_SUFFIX. */
+static char *key_name(const char *file) {
+  char *copy = strdup(file), *name = strdup(basename(copy));
+  size_t l = strlen(name), s = strlen(PK_SUFFIX);
+  if (l > s && strcmp(name + l - s, PK_SUFFIX) == 0) {
+    name[l - s] = '\0';
+  }
+  free(copy);
+  return name;
+}
+
+int main(int argc, char **argv) {
+  char *create = NULL, *list = NULL, *export = NULL;
+  int option, validated = 0;
+
+  while ((option = getopt(argc, argv, "hc:Vl:x:")) != -1) {
+    switch (option) {
+    case 'c':
+      create = optarg;
+      break;
+    case 'V':
+      validated = 1;
+      break;
+    case 'l':
+      list = optarg;
+      break;
+    case 'x':
+      export = optarg;
+      break;
+    case 'h':
+    default:
+      fprintf(stderr, "keystore-util version: %f\n", VERSION);
+      fprintf(stderr, "  -c keystore [-V] file.pk...: import hex public keys (named after their files)\n");
+      fprintf(stderr, "  -V: validate the keys while importing them (derivations then skip the validation)\n");
+      fprintf(stderr, "  -l keystore: list the keys and their flags\n");
+      fprintf(stderr, "  -x keystore name...: export keys as hex (the format of the .pk files)\n");
+      return (option == 'h') ? 0 : 1;
+    }
+  }
+  if ((create != NULL) + (list != NULL) + (export != NULL) != 1) {
+    fprintf(stderr, "Exactly one of -c, -l and -x is required\n");
+    return 1;
+  }
+
+  if (create != NULL) {
+    size_t n = argc - optind;
+    fp *keys = calloc(n ? n : 1, sizeof(fp));
+    const char **names = calloc(n ? n : 1, sizeof(char *));
+    int ok = (keys != NULL && names != NULL);
+    for (size_t i = 0; ok && i < n; ++i) {
+      names[i] = key_name(argv[optind + i]);
+      ok = read_hex_key(argv[optind + i], keys[i]);
+    }
+    if (ok && keystore_write(create, names, (const fp *)keys, n, validated) != 0) {
+      fprintf(stderr, "Unable to write %s (duplicated or too long names?)\n", create);
+      ok = 0;
+    }
+    for (size_t i = 0; names != NULL && i < n; ++i) {
+      free((char *)names[i]);
+    }
+    free(names);
+    free(keys);
+    return ok ? 0 : 1;
+  }
+
+  keystore *ks = keystore_open((list != NULL) ? list : export);
+  if (ks == NULL) {
+    fprintf(stderr, "Unable to open %s as a keystore\n", (list != NULL) ? list : export);
+    return 1;
+  }
+  if (list != NULL) {
+    for (size_t i = 0; i < keystore_count(ks); ++i) {
+      const keystore_entry *entry = keystore_entry_at(ks, i);
+      printf("%-24s %c%c ", entry->name, (entry->flags & KEYSTORE_VALIDATED) ? 'V' : '-',
+             (entry->flags & KEYSTORE_EDWARDS) ? 'E' : '-');
+      print_hex_key(stdout, keystore_public_key(ks, entry));
+    }
+  } else {
+    for (int i = optind; i < argc; ++i) {
+      const keystore_entry *entry = keystore_find(ks, argv[i]);
+      if (entry == NULL) {
+        fprintf(stderr, "No key named %s\n", argv[i]);
+        keystore_close(ks);
+        return 1;
+      }
+      print_hex_key(stdout, keystore_public_key(ks, entry));
+    }
+  }
+  keystore_close(ks);
+  return 0;
+}
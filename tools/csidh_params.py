@@ -0,0 +1,687 @@
+#!/usr/bin/env python3
+"""Parameter-set generator for CSIDH primes p = 4 * l_1 * ... * l_n - 1.
+
+Given the list of small primes l_i (in the order of the tables), it writes
+
+    lib/fp<BITS>.S                        fixed-width Montgomery arithmetic (mulx/adcx/adox)
+    inc/fp<BITS>/addc.h                   E, ADDITION_CHAIN, L, BITS_OF_L, ...
+    inc/fp<BITS>/simba_dummyfree.h        SIMBA parameters of each TYPE
+    inc/fp<BITS>/simba_withdummy_1.h
+    inc/fp<BITS>/simba_withdummy_2.h
+
+and prints the block to add to inc/fp.h. <BITS> is the label of the set (the BITLENGTH_OF_P of
+the Makefile); p itself must have at most BITS - 1 bits (the most significant word of p below 2^63 - 1
+lets the Montgomery multiplication drop the carry word, as in lib/fp512.S).
+
+    tools/csidh_params.py generate tools/params/p1024.primes 1024
+    tools/csidh_params.py search 1024 > tools/params/p1024.primes
+
+The exponent bounds are uniform: the smallest B such that the key space of each TYPE has at least
+2^KEY_BITS keys. They are a starting point, not the cost-optimized bounds of the p512 tables.
+"""
+
+import argparse
+import math
+import os
+import random
+import sys
+
+ROOT = os.path.normpath(os.path.join(os.path.dirname(os.path.abspath(__file__)), '..'))
+
+
+# ------------------------------------------------------------------------------------------------
+# Arithmetic
+
+def is_probable_prime(n, rounds=40):
+    if n < 2:
+        return False
+    for q in (2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37):
+        if n % q == 0:
+            return n == q
+    d, s = n - 1, 0
+    while d % 2 == 0:
+        d, s = d // 2, s + 1
+    rng = random.Random(n)
+    for _ in range(rounds):
+        x = pow(rng.randrange(2, n - 1), d, n)
+        if x in (1, n - 1):
+            continue
+        for _ in range(s - 1):
+            x = x * x % n
+            if x == n - 1:
+                break
+        else:
+            return False
+    return True
+
+
+def odd_primes(count=None, above=2):
+    q = above + 1
+    found = 0
+    while count is None or found < count:
+        if is_probable_prime(q):
+            yield q
+            found += 1
+        q += 1
+
+
+def words_of(x, n):
+    return [(x >> (64 * k)) & 0xFFFFFFFFFFFFFFFF for k in range(n)]
+
+
+# ------------------------------------------------------------------------------------------------
+# Differential addition chains, in the encoding of yMUL(): the chain starts at (P, [2]P, [3]P) and
+# each bit b maps (R0, R1, R2) to (R[b ^ 1], R2, R2 + R[b ^ 1]), the difference being R[b]. The
+# first bit is the least significant one.
+
+def chain_value(chain, length):
+    r = (1, 2, 3)
+    for _ in range(length):
+        b = chain & 1
+        r = (r[b ^ 1], r[2], r[2] + r[b ^ 1])
+        chain >>= 1
+    return r[2]
+
+
+def largest_value(r1, r2, steps):
+    """Largest value reachable from (., r1, r2) in the given number of steps (always b = 0)."""
+    for _ in range(steps):
+        r1, r2 = r2, r1 + r2
+    return r2
+
+
+def shortest_chain(l, max_length=63):
+    """Shortest chain computing l (the first one in increasing order of its bits); None if none."""
+    if l == 3:
+        return 0, 0
+    for length in range(1, max_length + 1):
+        # Depth-first search with pruning: the values only grow along the chain, at most as fast as
+        # the Fibonacci numbers
+        stack = [((1, 2, 3), 0, 0)]
+        while stack:
+            r, depth, bits = stack.pop()
+            if depth == length:
+                if r[2] == l:
+                    return bits, length
+                continue
+            if largest_value(r[1], r[2], length - depth) < l:
+                continue
+            for b in (1, 0):
+                t = r[2] + r[b ^ 1]
+                if t <= l:
+                    stack.append(((r[b ^ 1], r[2], t), depth + 1, bits | (b << depth)))
+    return None
+
+
+# ------------------------------------------------------------------------------------------------
+# Prime search: the first odd primes, the last one replaced until p = 4 * prod - 1 is prime
+
+def search_primes(bits, seed=0):
+    limit = 2 ** (bits - 1) - 2 ** (bits - 64)
+    primes = []
+    product = 4
+    for q in odd_primes():
+        if product * q * 2048 > limit:		# leaves room for the replaced prime
+            break
+        primes.append(q)
+        product *= q
+    last = primes[-1]
+    for q in odd_primes(above=last):
+        if product * q >= limit:
+            raise SystemExit('no prime p of %d bits with %d small primes' % (bits - 1, len(primes) + 1))
+        if is_probable_prime(product * q - 1):
+            return primes + [q]
+
+
+def read_primes(path):
+    with open(path) as f:
+        text = ' '.join(line.split('#')[0] for line in f)	# '#' starts a comment
+    primes = [int(t) for t in text.replace(',', ' ').split()]
+    if len(set(primes)) != len(primes) or any((l < 3) or not is_probable_prime(l) for l in primes):
+        raise SystemExit('%s: the l_i must be distinct odd primes' % path)
+    return primes
+
+
+# ------------------------------------------------------------------------------------------------
+# lib/fp<BITS>.S
+
+def quads(values, indent='    '):
+    lines = []
+    for k in range(0, len(values), 4):
+        lines.append(indent + '.quad ' + ', '.join('0x%016x' % v for v in values[k:k + 4]))
+    return '\n'.join(lines)
+
+
+def emit_asm(p, n, bits):
+    R = 2 ** (64 * n)
+    pbits = p.bit_length()
+    inv = (-pow(p, -1, 2 ** 64)) % 2 ** 64
+    out = []
+    w = out.append
+
+    w('/* Generated by tools/csidh_params.py: %d-word Montgomery arithmetic modulo a %d-bit prime */' % (n, pbits))
+    w('.intel_syntax noprefix')
+    w('')
+    w('.section .rodata')
+    w('')
+    w('.set pbits, %d' % pbits)
+    w('.global p')
+    w('p:')
+    w(quads(words_of(p, n)))
+    w('')
+    w('.global R_mod_p')
+    w('R_mod_p: /* 2^%d mod p */' % (64 * n))
+    w(quads(words_of(R % p, n)))
+    w('')
+    w('/* (2^%d)^2 mod p */' % (64 * n))
+    w('.global R_squared_mod_p')
+    w('R_squared_mod_p:')
+    w(quads(words_of(R * R % p, n)))
+    w('')
+    w('/* (2^%d)^3 mod p */' % (64 * n))
+    w('.global R_cubed_mod_p')
+    w('R_cubed_mod_p:')
+    w(quads(words_of(R * R * R % p, n)))
+    w('')
+    w('/* -p^-1 mod 2^64 */')
+    w('.inv_min_p_mod_r:')
+    w('    .quad 0x%016x' % inv)
+    w('')
+    w('.p_minus_2:')
+    w(quads(words_of(p - 2, n)))
+    w('')
+    w('.global p_minus_1_halves')
+    w('p_minus_1_halves:')
+    w(quads(words_of((p - 1) // 2, n)))
+    w('')
+    w('.section .text')
+    w('')
+
+    # Integer addition and subtraction (the carry is returned in rax)
+    for name, first, rest in (('add', 'add', 'adc'), ('sub', 'sub', 'sbb')):
+        w('.u%d_%s:' % (64 * n, name))
+        w('    mov rax, [rsi +  0]')
+        w('    %s rax, [rdx +  0]' % first)
+        w('    mov [rdi +  0], rax')
+        w('    .set k, 1')
+        w('    .rept %d' % (n - 1))
+        w('        mov rax, [rsi + 8*k]')
+        w('        %s rax, [rdx + 8*k]' % rest)
+        w('        mov [rdi + 8*k], rax')
+        w('        .set k, k+1')
+        w('    .endr')
+        w('    setc al')
+        w('    movzx rax, al')
+        w('    ret')
+        w('')
+
+    w('.global fp_copy')
+    w('fp_copy:')
+    w('    cld')
+    w('    mov rcx, %d' % n)
+    w('    rep movsq')
+    w('    ret')
+    w('')
+    w('.global fp_cswap')
+    w('fp_cswap:')
+    w('    movzx rax, dl')
+    w('    neg rax')
+    w('    .set k, 0')
+    w('    .rept %d' % n)
+    w('        mov rcx, [rdi + 8*k]')
+    w('        mov rdx, [rsi + 8*k]')
+    w('        mov r8, rcx')
+    w('        xor r8, rdx')
+    w('        and r8, rax')
+    w('        xor rcx, r8')
+    w('        xor rdx, r8')
+    w('        mov [rdi + 8*k], rcx')
+    w('        mov [rsi + 8*k], rdx')
+    w('        .set k, k+1')
+    w('    .endr')
+    w('    ret')
+    w('')
+
+    # x - p is kept (in constant time) if it does not borrow
+    w('.reduce_once:')
+    w('    sub rsp, %d' % (8 * n))
+    w('    mov rax, [rdi +  0]')
+    w('    sub rax, [rip + p +  0]')
+    w('    mov [rsp +  0], rax')
+    w('    .set k, 1')
+    w('    .rept %d' % (n - 1))
+    w('        mov rax, [rdi + 8*k]')
+    w('        sbb rax, [rip + p + 8*k]')
+    w('        mov [rsp + 8*k], rax')
+    w('        .set k, k+1')
+    w('    .endr')
+    w('    sbb rdx, rdx /* all ones if x < p */')
+    w('    .set k, 0')
+    w('    .rept %d' % n)
+    w('        mov rax, [rdi + 8*k]')
+    w('        mov rcx, [rsp + 8*k]')
+    w('        xor rax, rcx')
+    w('        and rax, rdx')
+    w('        xor rax, rcx')
+    w('        mov [rdi + 8*k], rax')
+    w('        .set k, k+1')
+    w('    .endr')
+    w('    add rsp, %d' % (8 * n))
+    w('    ret')
+    w('')
+    w('.global fp_add')
+    w('fp_add:')
+    w('    push rdi')
+    w('    call .u%d_add' % (64 * n))
+    w('    pop rdi')
+    w('    jmp .reduce_once')
+    w('')
+    w('.global fp_sub')
+    w('fp_sub:')
+    w('    push rdi')
+    w('    call .u%d_sub' % (64 * n))
+    w('    pop rdi')
+    w('    neg rax /* all ones if x < y */')
+    w('    sub rsp, %d' % (8 * n))
+    w('    .set k, 0')
+    w('    .rept %d' % n)
+    w('        mov rcx, [rip + p + 8*k]')
+    w('        and rcx, rax')
+    w('        mov [rsp + 8*k], rcx')
+    w('        .set k, k+1')
+    w('    .endr')
+    w('    mov rcx, [rsp +  0]')
+    w('    add [rdi +  0], rcx')
+    w('    .set k, 1')
+    w('    .rept %d' % (n - 1))
+    w('        mov rcx, [rsp + 8*k]')
+    w('        adc [rdi + 8*k], rcx')
+    w('        .set k, k+1')
+    w('    .endr')
+    w('    add rsp, %d' % (8 * n))
+    w('    ret')
+    w('')
+
+    # Montgomery multiplication (CIOS). Too many words for the accumulator to fit in registers: it
+    # lives on the stack, and step k works on the window T[k], ..., T[k + n] of 2n words. Each step
+    # interleaves two carry chains (adcx for the high halves, adox for the accumulator).
+    w('/* Montgomery arithmetic */')
+    w('')
+    w('.global fp_mul')
+    w('fp_mul:')
+    w('    push rbx')
+    w('    push rdi')
+    w('    mov rdi, rsi')
+    w('    mov rsi, rdx')
+    w('    sub rsp, %d' % (16 * n))
+    w('    xor r8, r8')
+    w('    .set k, 0')
+    w('    .rept %d' % (2 * n))
+    w('        mov [rsp + 8*k], r8')
+    w('        .set k, k+1')
+    w('    .endr')
+    w('')
+    w('.macro ACCUMULATE, k, src')
+    w('    xor rax, rax /* clear flags */')
+    w('    mulx rbx, rax, [\\src +  0]')
+    w('    adox rax, [rsp + 8*\\k]')
+    w('    mov [rsp + 8*\\k], rax')
+    w('    .set j, 1')
+    w('    .rept %d' % ((n - 1) // 2))
+    w('        mulx rcx, rax, [\\src + 8*j]')
+    w('        adcx rax, rbx')
+    w('        adox rax, [rsp + 8*(\\k + j)]')
+    w('        mov [rsp + 8*(\\k + j)], rax')
+    w('        mulx rbx, rax, [\\src + 8*(j + 1)]')
+    w('        adcx rax, rcx')
+    w('        adox rax, [rsp + 8*(\\k + j + 1)]')
+    w('        mov [rsp + 8*(\\k + j + 1)], rax')
+    w('        .set j, j+2')
+    w('    .endr')
+    if n % 2 == 0:
+        w('    mulx rcx, rax, [\\src + 8*%d]' % (n - 1))
+        w('    adcx rax, rbx')
+        w('    adox rax, [rsp + 8*(\\k + %d)]' % (n - 1))
+        w('    mov [rsp + 8*(\\k + %d)], rax' % (n - 1))
+        last = 'rcx'
+    else:
+        last = 'rbx'
+    w('    mov rax, [rsp + 8*(\\k + %d)]' % n)
+    w('    adcx rax, %s' % last)
+    w('    adox rax, r8')
+    w('    mov [rsp + 8*(\\k + %d)], rax' % n)
+    w('.endm')
+    w('')
+    w('.macro MULSTEP, k')
+    w('    mov rdx, [rsi +  0]')
+    w('    mulx rcx, rdx, [rdi + 8*\\k]')
+    w('    add rdx, [rsp + 8*\\k]')
+    w('    mulx rcx, rdx, [rip + .inv_min_p_mod_r]')
+    w('    lea r9, [rip + p]')
+    w('    ACCUMULATE \\k, r9')
+    w('    mov rdx, [rdi + 8*\\k]')
+    w('    ACCUMULATE \\k, rsi')
+    w('.endm')
+    w('')
+    w('    .set i, 0')
+    w('    .rept %d' % n)
+    w('        MULSTEP i')
+    w('        .set i, i+1')
+    w('    .endr')
+    w('')
+    w('    mov rdi, [rsp + %d]' % (16 * n))
+    w('    .set k, 0')
+    w('    .rept %d' % n)
+    w('        mov rax, [rsp + 8*(%d + k)]' % n)
+    w('        mov [rdi + 8*k], rax')
+    w('        .set k, k+1')
+    w('    .endr')
+    w('    add rsp, %d' % (16 * n + 8))
+    w('    pop rbx')
+    w('    jmp .reduce_once')
+    w('')
+    w('.fp_mul2:')
+    w('    mov rdx, rdi')
+    w('    jmp fp_mul')
+    w('')
+    w('.global fp_sqr')
+    w('fp_sqr:')
+    w('    mov rdx, rsi')
+    w('    jmp fp_mul')
+    w('')
+    w('.fp_sq1:')
+    w('    mov rsi, rdi')
+    w('    jmp fp_sqr')
+    w('')
+
+    # Left-to-right exponentiation (not constant time in the exponent, which is public)
+    w('/* (obviously) not constant time in the exponent! */')
+    w('.fp_pow:')
+    w('    push rbx')
+    w('    mov rbx, rsi')
+    w('    push r12')
+    w('    push r13')
+    w('    push rdi')
+    w('    sub rsp, %d' % (8 * n))
+    w('')
+    w('    mov rsi, rdi')
+    w('    mov rdi, rsp')
+    w('    call fp_copy')
+    w('')
+    w('    mov rdi, [rsp + %d]' % (8 * n))
+    w('    lea rsi, [rip + R_mod_p]')
+    w('    call fp_copy')
+    w('')
+    w('.macro POWSTEP, k')
+    w('        mov r13, [rbx + 8*\\k]')
+    w('        xor r12, r12')
+    w('')
+    w('        0:')
+    w('        test r13, 1')
+    w('        jz 1f')
+    w('')
+    w('        mov rdi, [rsp + %d]' % (8 * n))
+    w('        mov rsi, rsp')
+    w('        call .fp_mul2')
+    w('')
+    w('        1:')
+    w('        mov rdi, rsp')
+    w('        call .fp_sq1')
+    w('')
+    w('        shr r13')
+    w('')
+    w('        inc r12')
+    w('        test r12, 64')
+    w('        jz 0b')
+    w('.endm')
+    w('')
+    w('    .set k, 0')
+    w('    .rept %d' % n)
+    w('        POWSTEP k')
+    w('        .set k, k+1')
+    w('    .endr')
+    w('')
+    w('    add rsp, %d+8' % (8 * n))
+    w('    pop r13')
+    w('    pop r12')
+    w('    pop rbx')
+    w('    ret')
+    w('')
+    w('.global fp_inv')
+    w('fp_inv:')
+    w('    lea rsi, [rip + .p_minus_2]')
+    w('    jmp .fp_pow')
+    w('')
+    w('.global fp_issquare')
+    w('fp_issquare:')
+    w('    push rdi')
+    w('    lea rsi, [rip + p_minus_1_halves]')
+    w('    call .fp_pow')
+    w('    pop rdi')
+    w('')
+    w('    xor rax, rax')
+    w('    .set k, 0')
+    w('    .rept %d' % n)
+    w('        mov rsi, [rdi + 8*k]')
+    w('        xor rsi, [rip + R_mod_p + 8*k]')
+    w('        or rax, rsi')
+    w('        .set k, k+1')
+    w('    .endr')
+    w('    test rax, rax')
+    w('    setz al')
+    w('    movzx rax, al')
+    w('    ret')
+    w('')
+
+    # Rejection sampling (the limbs are compared as unsigned integers)
+    w('/* not constant time (but this shouldn\'t leak anything of importance) */')
+    w('.global fp_random')
+    w('fp_random:')
+    w('    push rdi')
+    w('    mov rsi, %d' % (8 * n))
+    w('    call randombytes')
+    w('    pop rdi')
+    if pbits % 64:
+        w('    mov rax, 1')
+        w('    shl rax, (pbits % 64)')
+        w('    dec rax')
+        w('    and [rdi + %d], rax' % (8 * (n - 1)))
+    w('')
+    w('    .set k, %d' % (n - 1))
+    w('    .rept %d' % n)
+    w('        mov rax, [rip + p + 8*k]')
+    w('        cmp [rdi + 8*k], rax')
+    w('        ja fp_random')
+    w('        jb 0f')
+    w('        .set k, k-1')
+    w('    .endr')
+    w('    jmp fp_random /* x = p */')
+    w('    0:')
+    w('    ret')
+    w('')
+    w('.section .note.GNU-stack,"",@progbits')
+    return '\n'.join(out) + '\n'
+
+
+# ------------------------------------------------------------------------------------------------
+# inc/fp<BITS>/addc.h and inc/fp<BITS>/simba_*.h
+
+def rows(values, per_row, fmt):
+    lines = []
+    for k in range(0, len(values), per_row):
+        lines.append(', '.join(fmt % v for v in values[k:k + per_row]))
+    return ',\n'.join(lines)
+
+
+def fp_initializer(x, n):
+    return '{ ' + ', '.join('0x%X' % v for v in words_of(x, n)) + '}'
+
+
+def emit_addc(p, n, primes, chains):
+    R = 2 ** (64 * n)
+    out = []
+    w = out.append
+    w('#ifndef _ADDC_H_')
+    w('#define _ADDC_H_')
+    w('')
+    w('// Generated by tools/csidh_params.py')
+    w('')
+    w('// The public Edward\'s curve with coefficients a and b. E is isomorphic to E\' / F_p : y^2 = x^3 + x')
+    w('// a and (a - d) in Montgomery domain represetantion ')
+    w('static proj E = {')
+    w('%s,\t// a' % fp_initializer(2 * R % p, n))
+    w('%s\t// a - d' % fp_initializer(4 * R % p, n))
+    w('};')
+    w('')
+    w('// Shortest differential addition chains for each l_i')
+    w('static uint64_t ADDITION_CHAIN[] = {')
+    w(rows([c for c, _ in chains], 8, '0x%X'))
+    w('};')
+    w('')
+    w('// Length of the shortest differential addition chain for each l_i')
+    w('static uint8_t ADDITION_CHAIN_LENGTH[] = {')
+    w(rows([length for _, length in chains], 8, '%2d'))
+    w('};')
+    w('')
+    w('// L')
+    w('static uint32_t L[] = { ')
+    w(rows(primes, 8, '%3d'))
+    w('};')
+    w('')
+    w('static uint16_t BITS_OF_L[] = { ')
+    w(rows([l.bit_length() for l in primes], 8, '%2d'))
+    w('};')
+    w('')
+    w('#define BITS_OF_4SQRT_OF_P %d' % math.ceil(2 + math.log2(p) / 2))
+    w('#define LARGE_L %d' % max(primes))
+    w('// The l_i\'s are only required for isogeny constructions')
+    w('#endif /* Addition chains */')
+    return '\n'.join(out) + '\n'
+
+
+def emit_simba(n_primes, bound, batches, my, description):
+    out = []
+    w = out.append
+    members = [list(range(b, n_primes, batches)) for b in range(batches)]
+    w('#ifndef _SIMBA_PARAMETERS_H_')
+    w('#define _SIMBA_PARAMETERS_H_')
+    w('')
+    w('// Generated by tools/csidh_params.py')
+    w('')
+    w('// SIMBA-(NUMBER_OF_BATCHES)-MY')
+    w('#define NUMBER_OF_BATCHES %d' % batches)
+    w('#define MY %d' % my)
+    w('')
+    w('// (each entry corresponds to the number of degree-(l_i) to be required in the action: %s)' % description)
+    w('static int8_t B[] =\t{')
+    w(rows([bound] * n_primes, 8, '%2d'))
+    w('};')
+    w('')
+    w('// (NUMBER_OF_BATCHES) different subsets (i.e., batches)')
+    for b, m in enumerate(members):
+        w('static uint8_t BATCH_%d[] = { %s };' % (b, ', '.join(str(i) for i in m)))
+    w('')
+    w('static uint8_t SIZE_OF_EACH_BATCH[NUMBER_OF_BATCHES] = {%s};' % ', '.join(str(len(m)) for m in members))
+    w('static uint8_t *BATCHES[NUMBER_OF_BATCHES] = { %s };' % ', '.join('BATCH_%d' % b for b in range(batches)))
+    w('')
+    w('static uint8_t LAST_ISOGENY[NUMBER_OF_BATCHES] = { %s };' % ', '.join(str(m[-1]) for m in members))
+    w('static uint16_t NUMBER_OF_ISOGENIES = %d;' % (bound * n_primes))
+    w('')
+    w('// The complement of each batch')
+    w('static uint8_t SIZE_OF_EACH_COMPLEMENT_BATCH[NUMBER_OF_BATCHES] = {%s};'
+      % ', '.join(str(n_primes - len(m)) for m in members))
+    w('static uint8_t COMPLEMENT_OF_EACH_BATCH[NUMBER_OF_BATCHES][N] = {')
+    blocks = []
+    for m in members:
+        complement = [i for i in range(n_primes) if i not in m]
+        complement += [n_primes] * (n_primes - len(complement))
+        blocks.append('{ ' + rows(complement, 8, '%3d') + ' }')
+    w(',\n'.join(blocks))
+    w('};')
+    w('#endif')
+    return '\n'.join(out) + '\n'
+
+
+# ------------------------------------------------------------------------------------------------
+
+def generate(args):
+    primes = read_primes(args.primes)
+    bits = args.bits
+    if bits % 64:
+        raise SystemExit('the bit length of the set must be a multiple of 64')
+    n = bits // 64
+    p = 4 * math.prod(primes) - 1
+    if not is_probable_prime(p):
+        raise SystemExit('4 * prod(l_i) - 1 is not prime')
+    if p >= 2 ** (bits - 1) - 2 ** (bits - 64):
+        raise SystemExit('p has %d bits: at most %d are supported by %d words' % (p.bit_length(), bits - 1, n))
+    if len(primes) > 254:
+        raise SystemExit('at most 254 l_i\'s (the tables index them with uint8_t)')
+
+    chains = []
+    for l in primes:
+        chain = shortest_chain(l)
+        if chain is None:
+            raise SystemExit('no addition chain for %d' % l)
+        assert chain_value(*chain) == l
+        chains.append(chain)
+
+    # Uniform bounds: B + 1 keys per l_i with one torsion point or dummy-free, 2B + 1 with two points
+    one_sided = max(1, math.ceil(2 ** (args.key_bits / len(primes)) - 1))
+    two_sided = max(1, math.ceil((2 ** (args.key_bits / len(primes)) - 1) / 2))
+    if max(one_sided, two_sided) > 63:
+        raise SystemExit('too few l_i\'s for a key space of 2^%d' % args.key_bits)
+
+    files = {
+        os.path.join('lib', 'fp%d.S' % bits): emit_asm(p, n, bits),
+        os.path.join('inc', 'fp%d' % bits, 'addc.h'): emit_addc(p, n, primes, chains),
+        os.path.join('inc', 'fp%d' % bits, 'simba_dummyfree.h'):
+            emit_simba(len(primes), one_sided, 5, 11, 'uniform, dummy-free key space of (B + 1)^N'),
+        os.path.join('inc', 'fp%d' % bits, 'simba_withdummy_1.h'):
+            emit_simba(len(primes), one_sided, 5, 11, 'uniform, key space of (B + 1)^N'),
+        os.path.join('inc', 'fp%d' % bits, 'simba_withdummy_2.h'):
+            emit_simba(len(primes), two_sided, 3, 8, 'uniform, key space of (2B + 1)^N'),
+    }
+    for path, content in files.items():
+        full = os.path.join(args.output, path)
+        os.makedirs(os.path.dirname(full), exist_ok=True)
+        with open(full, 'w') as f:
+            f.write(content)
+        print('wrote %s' % full, file=sys.stderr)
+
+    print('#elif defined FP_%d' % bits)
+    print('\t#define N %d\t\t\t// Number of l_i\'s such that l_i | [(p+1)/4]' % len(primes))
+    print('\t#define LOG2_OF_N_PLUS_ONE %d' % (len(primes) + 1).bit_length())
+    print('\t#define NUMBER_OF_WORDS %d\t// Number of 64-bit words' % n)
+    print('p has %d bits; bounds B = %d (dummy-free, one point) and %d (two points)'
+          % (p.bit_length(), one_sided, two_sided), file=sys.stderr)
+
+
+def search(args):
+    primes = search_primes(args.bits)
+    p = 4 * math.prod(primes) - 1
+    print('# %d l_i\'s, p = 4 * prod(l_i) - 1 has %d bits' % (len(primes), p.bit_length()))
+    print(rows(sorted(primes, reverse=True), 16, '%d').replace(',\n', '\n').replace(',', ''))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    commands = parser.add_subparsers(dest='command', required=True)
+
+    g = commands.add_parser('generate', help='write the field backend and tables of a parameter set')
+    g.add_argument('primes', help='file with the l_i\'s, in the order of the tables')
+    g.add_argument('bits', type=int, help='label of the set (BITLENGTH_OF_P), a multiple of 64')
+    g.add_argument('--key-bits', type=float, default=256, help='minimum key space in bits (default: 256)')
+    g.add_argument('--output', default=ROOT, help='root of the tree (default: this repository)')
+    g.set_defaults(run=generate)
+
+    s = commands.add_parser('search', help='print l_i\'s making 4 * prod(l_i) - 1 a prime of at most bits - 1 bits')
+    s.add_argument('bits', type=int)
+    s.set_defaults(run=search)
+
+    args = parser.parse_args()
+    args.run(args)
+
+
+if __name__ == '__main__':
+    main()
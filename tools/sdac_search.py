@@ -0,0 +1,188 @@
+#!/usr/bin/env python3
+"""Shortest differential addition chains (SDACs) of the ADDITION_CHAIN tables.
+
+For each l_i of an addc.h, it searches the shortest chain in the encoding of yMUL() (see
+tools/csidh_params.py), checks it by evaluating it on random points of the curve against a plain
+Montgomery ladder, and reports the steps saved with respect to the chain of the table:
+
+    tools/sdac_search.py inc/fp512/addc.h
+    tools/sdac_search.py inc/fp512/addc.h --write      # replaces the tables by the shorter chains
+
+The search runs on --jobs processes and is resumable: each l_i found is written to the checkpoint
+(by default <fpNNNN>.sdac.json in the current directory), and is not searched again by a later run.
+Entries of the table that are valid and as short as the ones found are kept as they are.
+"""
+
+import argparse
+import json
+import math
+import multiprocessing
+import os
+import random
+import re
+import sys
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from csidh_params import chain_value, shortest_chain, rows     # noqa: E402
+
+# One step of a chain is one yADD_or_DBL() of yMUL(): 6M + 7a (and seven constant-time selections)
+STEP_COST = {'M': 6, 'a': 7}
+
+
+# ------------------------------------------------------------------------------------------------
+# Tables of an addc.h
+
+def read_table(text, name):
+    match = re.search(r'\b%s\[\]\s*=\s*\{([^}]*)\}' % name, text)
+    if match is None:
+        raise SystemExit('no table %s' % name)
+    return [int(t, 0) for t in match.group(1).replace(',', ' ').split()]
+
+
+def write_table(text, name, body):
+    return re.sub(r'(\b%s\[\]\s*=\s*\{)[^}]*(\})' % name, lambda m: m.group(1) + '\n' + body + '\n' + m.group(2),
+                  text, count=1)
+
+
+# ------------------------------------------------------------------------------------------------
+# Projective Edwards y-coordinates, with the same formulas as yDBL() and yADD() of lib/point_arith.c
+
+def ydbl(P, A, p):
+    t0, t1 = P[0] * P[0] % p, P[1] * P[1] % p
+    q1 = A[1] * t0 % p
+    q0 = q1 * t1 % p
+    t1 = (t1 - t0) % p
+    t0 = A[0] * t1 % p
+    q1 = (q1 + t0) % p
+    t0 = q1 * t1 % p
+    return ((q0 - t0) % p, (q0 + t0) % p)
+
+
+def yadd(P, Q, PQ, p):
+    xd, zd = (PQ[1] + PQ[0]) % p, (PQ[1] - PQ[0]) % p
+    t0, t1 = P[1] * Q[0] % p, P[0] * Q[1] % p
+    r1, r0 = (t0 - t1) ** 2 % p, (t0 + t1) ** 2 % p
+    t0, t1 = r0 * zd % p, r1 * xd % p
+    return ((t0 - t1) % p, (t0 + t1) % p)
+
+
+def ymul_chain(P, A, p, chain, length):
+    # yMUL() with the infinity checks left out: the points used here have a large order
+    R = [P, ydbl(P, A, p), None]
+    R[2] = yadd(R[1], R[0], P, p)
+    for _ in range(length):
+        b = chain & 1
+        R = [R[b ^ 1], R[2], yadd(R[2], R[b ^ 1], R[b], p)]
+        chain >>= 1
+    return R[2]
+
+
+def ymul_ladder(P, A, p, k):
+    R0, R1 = P, ydbl(P, A, p)
+    for bit in bin(k)[3:]:
+        if bit == '1':
+            R0, R1 = yadd(R1, R0, P, p), ydbl(R1, A, p)
+        else:
+            R0, R1 = ydbl(R0, A, p), yadd(R1, R0, P, p)
+    return R0
+
+
+def same_point(P, Q, p):
+    return (P[0] * Q[1] - P[1] * Q[0]) % p == 0
+
+
+def verify(l, chain, length, p, points=4, seed=0):
+    """The chain computes l and agrees with the ladder on random y's (of E or of its twist)."""
+    if chain_value(chain, length) != l:
+        return False
+    rng = random.Random(seed ^ l)
+    A = (2, 4)      # E: a = 2, a - d = 4, as the (Montgomery-domain) E of the tables
+    for _ in range(points):
+        P = (rng.randrange(2, p - 1), 1)
+        if not same_point(ymul_chain(P, A, p, chain, length), ymul_ladder(P, A, p, l), p):
+            return False
+    return True
+
+
+# ------------------------------------------------------------------------------------------------
+def search_one(task):
+    l, max_length = task
+    return l, shortest_chain(l, max_length)
+
+
+def load_checkpoint(path):
+    if not os.path.exists(path):
+        return {}
+    with open(path) as f:
+        return {int(l): (int(c, 16), n) for l, (c, n) in json.load(f).items()}
+
+
+def save_checkpoint(path, found):
+    tmp = path + '.tmp'
+    with open(tmp, 'w') as f:
+        json.dump({str(l): ['0x%X' % c, n] for l, (c, n) in sorted(found.items())}, f, indent=1)
+    os.replace(tmp, path)    # a run interrupted while writing leaves the previous checkpoint
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('addc', help='addc.h with the tables L, ADDITION_CHAIN and ADDITION_CHAIN_LENGTH')
+    parser.add_argument('--jobs', type=int, default=os.cpu_count(), help='processes (default: all CPUs)')
+    parser.add_argument('--checkpoint', help='results of previous runs (default: <fpNNNN>.sdac.json)')
+    parser.add_argument('--max-length', type=int, default=63, help='longest chain searched (default: 63)')
+    parser.add_argument('--points', type=int, default=4, help='random points of the ladder check (default: 4)')
+    parser.add_argument('--write', action='store_true', help='write the shorter chains into the addc.h')
+    args = parser.parse_args()
+
+    with open(args.addc) as f:
+        text = f.read()
+    L = read_table(text, 'L')
+    table = list(zip(read_table(text, 'ADDITION_CHAIN'), read_table(text, 'ADDITION_CHAIN_LENGTH')))
+    if len(table) != len(L):
+        raise SystemExit('%s: %d chains for %d l_i\'s' % (args.addc, len(table), len(L)))
+    p = 4 * math.prod(L) - 1
+    checkpoint = args.checkpoint or '%s.sdac.json' % os.path.basename(os.path.dirname(os.path.abspath(args.addc)))
+
+    found = load_checkpoint(checkpoint)
+    todo = [(l, args.max_length) for l in sorted(set(L) - set(found), reverse=True)]
+    if todo:
+        print('searching %d chains (%d in %s)' % (len(todo), len(found), checkpoint), file=sys.stderr)
+        with multiprocessing.Pool(max(1, args.jobs)) as pool:
+            for l, chain in pool.imap_unordered(search_one, todo):
+                if chain is None:
+                    raise SystemExit('no chain of at most %d steps for %d' % (args.max_length, l))
+                found[l] = chain
+                save_checkpoint(checkpoint, found)
+
+    # Report, and the new tables: the entries of the table are kept unless they are wrong or longer
+    new_table, saved = [], 0
+    print('%5s  %10s %6s  %10s %6s  %s' % ('l', 'table', 'steps', 'shortest', 'steps', ''))
+    for l, (chain, length) in zip(L, table):
+        best = found[l]
+        if not verify(l, *best, p, args.points):
+            raise SystemExit('the chain 0x%X of %d does not agree with the ladder' % (best[0], l))
+        valid = verify(l, chain, length, p, args.points)
+        if valid and length <= best[1]:
+            new_table.append((chain, length))
+            status = ''
+        else:
+            new_table.append(best)
+            saved += length - best[1] if valid else 0
+            status = 'saves %d' % (length - best[1]) if valid else 'WRONG in the table'
+        print('%5d  %10s %6d  %10s %6d  %s' % (l, '0x%X' % chain, length, '0x%X' % best[0], best[1], status))
+
+    cost = ' + '.join('%d%s' % (c, op) for op, c in STEP_COST.items())
+    print('steps of one yMUL() per l_i: %d in the table, %d with the shortest chains' % (
+        sum(n for _, n in table), sum(n for _, n in new_table)))
+    print('saved: %d steps (of %s each) per yMUL() of all the l_i\'s' % (saved, cost))
+
+    if args.write and new_table != table:
+        text = write_table(text, 'ADDITION_CHAIN', rows(['0x%X' % c for c, _ in new_table], 8, '%5s'))
+        text = write_table(text, 'ADDITION_CHAIN_LENGTH', rows([n for _, n in new_table], 8, '%2d'))
+        with open(args.addc, 'w') as f:
+            f.write(text)
+        print('wrote %s' % args.addc, file=sys.stderr)
+
+
+if __name__ == '__main__':
+    main()